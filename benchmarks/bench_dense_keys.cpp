@@ -0,0 +1,76 @@
+#include <benchmark/benchmark.h>
+
+#include <frozen/map.h>
+#include <frozen/unordered_map.h>
+
+#include <functional>
+#include <random>
+#include <vector>
+
+// Enum to string, as in examples/enum_to_string.cpp: 41 relocation types
+// valued from 0 to 43, looked up with a switch, a sorted map and unordered
+// maps with and without a direct table
+
+enum reloc : unsigned {};
+
+#define RELOCS(X)                                                              \
+  X(0) X(1) X(2) X(3) X(4) X(5) X(6) X(7) X(8) X(9) X(10) X(11) X(14) X(15)    \
+  X(16) X(17) X(18) X(19) X(20) X(21) X(22) X(23) X(24) X(25) X(26) X(27)      \
+  X(28) X(29) X(30) X(31) X(32) X(33) X(34) X(35) X(36) X(37) X(39) X(40)      \
+  X(41) X(42) X(43)
+
+#define RELOC_CASE(value) case value: return "R" #value;
+#define RELOC_ITEM(value) {static_cast<reloc>(value), "R" #value},
+
+static char const *reloc_switch(reloc r) {
+  switch (r) {
+    RELOCS(RELOC_CASE)
+  default:
+    return nullptr;
+  }
+}
+
+static constexpr frozen::map<reloc, char const *, 41> reloc_map = {RELOCS(RELOC_ITEM)};
+
+static constexpr frozen::unordered_map<reloc, char const *, 41> reloc_unordered_map = {
+    RELOCS(RELOC_ITEM)};
+
+static constexpr frozen::unordered_map<reloc, char const *, 41, frozen::elsa<reloc>,
+                                       std::equal_to<reloc>, frozen::dense_pmh<>>
+    reloc_dense_map = {RELOCS(RELOC_ITEM)};
+
+static std::vector<reloc> const &reloc_queries() {
+  static std::vector<reloc> const queries = [] {
+    std::vector<reloc> result;
+    std::mt19937 gen(41);
+    for (std::size_t i = 0; i < 1024; ++i)
+      result.push_back(std::next(reloc_map.begin(), gen() % reloc_map.size())->first);
+    return result;
+  }();
+  return queries;
+}
+
+static void BM_RelocSwitch(benchmark::State& state) {
+  auto const &queries = reloc_queries();
+  for (auto _ : state) {
+    for (auto q : queries)
+      benchmark::DoNotOptimize(reloc_switch(q));
+  }
+  state.SetItemsProcessed(state.iterations() * queries.size());
+}
+
+template <class Map, Map const &map>
+static void BM_RelocMap(benchmark::State& state) {
+  auto const &queries = reloc_queries();
+  for (auto _ : state) {
+    for (auto q : queries)
+      benchmark::DoNotOptimize(map.find(q)->second);
+  }
+  state.SetItemsProcessed(state.iterations() * queries.size());
+  state.counters["bytes"] = sizeof(Map);
+}
+
+BENCHMARK(BM_RelocSwitch);
+BENCHMARK_TEMPLATE(BM_RelocMap, decltype(reloc_map), reloc_map);
+BENCHMARK_TEMPLATE(BM_RelocMap, decltype(reloc_unordered_map), reloc_unordered_map);
+BENCHMARK_TEMPLATE(BM_RelocMap, decltype(reloc_dense_map), reloc_dense_map);
@@ -0,0 +1,173 @@
+#include <benchmark/benchmark.h>
+
+#include <frozen/random.h>
+#include <frozen/unordered_map.h>
+#include <frozen/unordered_set.h>
+
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <random>
+#include <stdexcept>
+
+// Integer mixers of elsa, and hashes of composite keys: hashing speed,
+// lookups, and how many seeds the perfect hash construction draws, for
+// several key distributions
+
+static constexpr std::size_t KeyCount = 1024;
+using keys_type = frozen::bits::carray<std::uint64_t, KeyCount>;
+
+// The key set number `round` of each distribution
+struct sequential_keys {
+  keys_type operator()(std::uint64_t round) const {
+    keys_type keys;
+    for (std::size_t i = 0; i < KeyCount; ++i)
+      keys[i] = round * KeyCount + i;
+    return keys;
+  }
+};
+
+struct strided_keys {
+  keys_type operator()(std::uint64_t round) const {
+    keys_type keys;
+    for (std::size_t i = 0; i < KeyCount; ++i)
+      keys[i] = (round * KeyCount + i) << 12;
+    return keys;
+  }
+};
+
+struct random_keys {
+  keys_type operator()(std::uint64_t round) const {
+    std::mt19937_64 gen(round);
+    keys_type keys;
+    for (std::size_t i = 0; i < KeyCount; ++i)
+      keys[i] = gen(); // duplicates are unlikely enough
+    return keys;
+  }
+};
+
+// Counts the seeds drawn by the construction
+struct counting_prg {
+  frozen::default_prg_t prg;
+  std::size_t *calls;
+
+  frozen::default_prg_t::result_type operator()() {
+    ++*calls;
+    return prg();
+  }
+};
+
+template <class Mixer, class Keys>
+static void BM_IntHash(benchmark::State& state) {
+  auto const keys = Keys{}(0);
+  frozen::elsa<std::uint64_t, Mixer> const hash;
+  for (auto _ : state) {
+    for (auto key : keys)
+      benchmark::DoNotOptimize(hash(key, 0x1234));
+  }
+  state.SetItemsProcessed(state.iterations() * KeyCount);
+}
+
+template <class Mixer, class Keys>
+static void BM_IntLookup(benchmark::State& state) {
+  using set_type = frozen::unordered_set<std::uint64_t, KeyCount, frozen::elsa<std::uint64_t, Mixer>>;
+  auto const keys = Keys{}(0);
+  std::unique_ptr<set_type> const set(new set_type(keys));
+  for (auto _ : state) {
+    std::size_t found = 0;
+    for (auto key : keys)
+      found += set->count(key);
+    benchmark::DoNotOptimize(found);
+  }
+  state.SetItemsProcessed(state.iterations() * KeyCount);
+}
+
+template <class Mixer, class Keys>
+static void BM_IntPmhBuild(benchmark::State& state) {
+  std::size_t calls = 0, builds = 0, failures = 0;
+  for (auto _ : state) {
+    auto const keys = Keys{}(builds);
+    try {
+      auto const built = frozen::hanov_pmh::make(
+          keys, frozen::elsa<std::uint64_t, Mixer>{}, frozen::bits::Get{},
+          counting_prg{frozen::default_prg_t{static_cast<std::uint_fast32_t>(builds + 1)}, &calls});
+      benchmark::DoNotOptimize(built.tables);
+    } catch (std::runtime_error const &) {
+      ++failures;
+    }
+    ++builds;
+  }
+  state.counters["seeds"] = static_cast<double>(calls) / builds;
+  state.counters["failures"] = static_cast<double>(failures) / builds;
+}
+
+#define MIXER_BENCHMARKS(Mixer)                                                \
+  BENCHMARK_TEMPLATE(BM_IntHash, Mixer, sequential_keys);                     \
+  BENCHMARK_TEMPLATE(BM_IntHash, Mixer, random_keys);                         \
+  BENCHMARK_TEMPLATE(BM_IntLookup, Mixer, sequential_keys);                   \
+  BENCHMARK_TEMPLATE(BM_IntLookup, Mixer, strided_keys);                      \
+  BENCHMARK_TEMPLATE(BM_IntLookup, Mixer, random_keys);                       \
+  BENCHMARK_TEMPLATE(BM_IntPmhBuild, Mixer, sequential_keys);                 \
+  BENCHMARK_TEMPLATE(BM_IntPmhBuild, Mixer, strided_keys);                    \
+  BENCHMARK_TEMPLATE(BM_IntPmhBuild, Mixer, random_keys)
+
+MIXER_BENCHMARKS(frozen::multiply_fold_mixer);
+MIXER_BENCHMARKS(frozen::fmix_mixer);
+MIXER_BENCHMARKS(frozen::wang_mixer);
+
+// Composite keys: the points of a 32x32 grid
+using point = std::pair<std::uint32_t, std::uint32_t>;
+
+static frozen::bits::carray<point, KeyCount> grid_keys(std::uint32_t round) {
+  frozen::bits::carray<point, KeyCount> keys;
+  for (std::uint32_t i = 0; i < KeyCount; ++i)
+    keys[i] = {round * 32 + i / 32, i % 32};
+  return keys;
+}
+
+// A hand written combination, as often found
+struct shift_xor_point_hash {
+  constexpr std::size_t operator()(point const &value, std::size_t seed) const {
+    return frozen::elsa<std::uint64_t>{}((std::uint64_t(value.first) << 32) ^ value.second, seed);
+  }
+};
+
+template <class Hash>
+static void BM_PointLookup(benchmark::State& state) {
+  using map_type = frozen::unordered_map<point, std::uint32_t, KeyCount, Hash>;
+  auto const keys = grid_keys(0);
+  frozen::bits::carray<std::pair<point, std::uint32_t>, KeyCount> items;
+  for (std::size_t i = 0; i < KeyCount; ++i)
+    items[i] = {keys[i], static_cast<std::uint32_t>(i)};
+  std::unique_ptr<map_type> const map(new map_type(items));
+  for (auto _ : state) {
+    std::size_t found = 0;
+    for (auto key : keys)
+      found += map->count(key);
+    benchmark::DoNotOptimize(found);
+  }
+  state.SetItemsProcessed(state.iterations() * KeyCount);
+}
+BENCHMARK_TEMPLATE(BM_PointLookup, frozen::elsa<point>);
+BENCHMARK_TEMPLATE(BM_PointLookup, shift_xor_point_hash);
+
+template <class Hash>
+static void BM_PointPmhBuild(benchmark::State& state) {
+  std::size_t calls = 0, builds = 0, failures = 0;
+  for (auto _ : state) {
+    auto const keys = grid_keys(static_cast<std::uint32_t>(builds));
+    try {
+      auto const built = frozen::hanov_pmh::make(
+          keys, Hash{}, frozen::bits::Get{},
+          counting_prg{frozen::default_prg_t{static_cast<std::uint_fast32_t>(builds + 1)}, &calls});
+      benchmark::DoNotOptimize(built.tables);
+    } catch (std::runtime_error const &) {
+      ++failures;
+    }
+    ++builds;
+  }
+  state.counters["seeds"] = static_cast<double>(calls) / builds;
+  state.counters["failures"] = static_cast<double>(failures) / builds;
+}
+BENCHMARK_TEMPLATE(BM_PointPmhBuild, frozen::elsa<point>);
+BENCHMARK_TEMPLATE(BM_PointPmhBuild, shift_xor_point_hash);
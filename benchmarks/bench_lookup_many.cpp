@@ -0,0 +1,209 @@
+#include <benchmark/benchmark.h>
+
+#include <frozen/set.h>
+#include <frozen/unordered_set.h>
+
+#include <algorithm>
+#include <functional>
+#include <memory>
+#include <random>
+#include <vector>
+
+// Batched lookups against one key at a time, for several batch and container
+// sizes. Containers are built at runtime, on the heap. Their construction
+// still needs stack space of a few times their size, which bounds the sizes
+// below: larger ones, where batching pays off, need e.g. `ulimit -s unlimited`.
+
+// Keys spread evenly over the 32 bit range
+struct spread_keys {
+  unsigned operator()(unsigned i, unsigned) const { return 2 * i * 2654435761u; }
+};
+
+// Keys crowded towards zero
+struct skewed_keys {
+  unsigned operator()(unsigned i, unsigned n) const {
+    return static_cast<unsigned>(4e9 * (double(i) / n) * (double(i) / n) * (double(i) / n)) + 2 * i;
+  }
+};
+
+template <class Set, std::size_t N, class Keys = spread_keys>
+struct lookup_data {
+  std::unique_ptr<Set> set;
+  std::vector<unsigned> queries;
+
+  static lookup_data const &get() {
+    static lookup_data const data;
+    return data;
+  }
+
+private:
+  lookup_data() {
+    std::unique_ptr<frozen::bits::carray<unsigned, N>> keys(new frozen::bits::carray<unsigned, N>);
+    for (unsigned i = 0; i < N; ++i)
+      (*keys)[i] = Keys{}(i, N);
+    set.reset(new Set(*keys));
+
+    // one query out of two is a miss
+    std::mt19937 gen(N);
+    queries.resize(1 << 16);
+    for (auto &q : queries)
+      q = (*keys)[gen() % N] + (gen() & 1);
+  }
+};
+
+template <std::size_t N>
+using block_set = frozen::unordered_set<unsigned, N, frozen::elsa<unsigned>,
+                                        std::equal_to<unsigned>, frozen::block_pmh>;
+
+template <std::size_t N>
+using sorted_set = frozen::set<unsigned, N>;
+
+template <std::size_t N>
+using eytzinger_set = frozen::set<unsigned, N, std::less<unsigned>, frozen::eytzinger_layout>;
+
+template <std::size_t N>
+using stree_set = frozen::set<unsigned, N, std::less<unsigned>, frozen::stree_layout>;
+
+template <std::size_t N>
+using learned_set = frozen::set<unsigned, N, std::less<unsigned>, frozen::learned_layout>;
+
+template <class Set, std::size_t N, class Keys = spread_keys>
+static void BM_IntCount(benchmark::State& state) {
+  auto const &data = lookup_data<Set, N, Keys>::get();
+  for (auto _ : state) {
+    std::size_t found = 0;
+    for (auto q : data.queries)
+      found += data.set->count(q);
+    benchmark::DoNotOptimize(found);
+  }
+  state.SetItemsProcessed(state.iterations() * data.queries.size());
+  state.counters["bytes"] = sizeof(Set);
+}
+
+template <class Set, std::size_t N>
+static void BM_IntCountMany(benchmark::State& state) {
+  auto const &data = lookup_data<Set, N>::get();
+  std::size_t const batch = state.range(0);
+  std::vector<std::size_t> counts(batch);
+  for (auto _ : state) {
+    for (auto first = data.queries.begin(); first != data.queries.end(); first += batch)
+      data.set->count_many(first, first + batch, counts.begin());
+    benchmark::DoNotOptimize(counts.data());
+    benchmark::ClobberMemory();
+  }
+  state.SetItemsProcessed(state.iterations() * data.queries.size());
+  state.counters["bytes"] = sizeof(Set);
+}
+
+// Batches of keys in ascending order, as from a sorted log, looked up one at
+// a time, in lockstep, or each from the previous one
+template <class Set, std::size_t N>
+static std::vector<unsigned> sorted_batches(std::size_t batch) {
+  auto queries = lookup_data<Set, N>::get().queries;
+  for (auto first = queries.begin(); first != queries.end(); first += batch)
+    std::sort(first, first + batch);
+  return queries;
+}
+
+template <class Set, std::size_t N>
+static void BM_IntCountSortedOneByOne(benchmark::State& state) {
+  auto const &data = lookup_data<Set, N>::get();
+  auto const queries = sorted_batches<Set, N>(state.range(0));
+  for (auto _ : state) {
+    std::size_t found = 0;
+    for (auto q : queries)
+      found += data.set->count(q);
+    benchmark::DoNotOptimize(found);
+  }
+  state.SetItemsProcessed(state.iterations() * queries.size());
+}
+
+template <class Set, std::size_t N>
+static void BM_IntCountSortedMany(benchmark::State& state) {
+  auto const &data = lookup_data<Set, N>::get();
+  std::size_t const batch = state.range(0);
+  auto const queries = sorted_batches<Set, N>(batch);
+  std::vector<std::size_t> counts(batch);
+  for (auto _ : state) {
+    for (auto first = queries.begin(); first != queries.end(); first += batch)
+      data.set->count_many(first, first + batch, counts.begin());
+    benchmark::DoNotOptimize(counts.data());
+    benchmark::ClobberMemory();
+  }
+  state.SetItemsProcessed(state.iterations() * queries.size());
+}
+
+template <class Set, std::size_t N>
+static void BM_IntCountSorted(benchmark::State& state) {
+  auto const &data = lookup_data<Set, N>::get();
+  std::size_t const batch = state.range(0);
+  auto const queries = sorted_batches<Set, N>(batch);
+  std::vector<std::size_t> counts(batch);
+  for (auto _ : state) {
+    for (auto first = queries.begin(); first != queries.end(); first += batch)
+      data.set->count_sorted(first, first + batch, counts.begin());
+    benchmark::DoNotOptimize(counts.data());
+    benchmark::ClobberMemory();
+  }
+  state.SetItemsProcessed(state.iterations() * queries.size());
+}
+
+BENCHMARK_TEMPLATE(BM_IntCount, block_set<1 << 10>, 1 << 10);
+BENCHMARK_TEMPLATE(BM_IntCountMany, block_set<1 << 10>, 1 << 10)->Arg(16)->Arg(256);
+BENCHMARK_TEMPLATE(BM_IntCount, block_set<1 << 16>, 1 << 16);
+BENCHMARK_TEMPLATE(BM_IntCountMany, block_set<1 << 16>, 1 << 16)->Arg(16)->Arg(256);
+BENCHMARK_TEMPLATE(BM_IntCount, sorted_set<1 << 10>, 1 << 10);
+BENCHMARK_TEMPLATE(BM_IntCountMany, sorted_set<1 << 10>, 1 << 10)->Arg(16)->Arg(256);
+BENCHMARK_TEMPLATE(BM_IntCount, sorted_set<1 << 18>, 1 << 18);
+BENCHMARK_TEMPLATE(BM_IntCountMany, sorted_set<1 << 18>, 1 << 18)->Arg(16)->Arg(256);
+BENCHMARK_TEMPLATE(BM_IntCount, sorted_set<1 << 16>, 1 << 16);
+BENCHMARK_TEMPLATE(BM_IntCount, eytzinger_set<1 << 10>, 1 << 10);
+BENCHMARK_TEMPLATE(BM_IntCountMany, eytzinger_set<1 << 10>, 1 << 10)->Arg(16)->Arg(256);
+BENCHMARK_TEMPLATE(BM_IntCount, eytzinger_set<1 << 16>, 1 << 16);
+BENCHMARK_TEMPLATE(BM_IntCount, eytzinger_set<1 << 18>, 1 << 18);
+BENCHMARK_TEMPLATE(BM_IntCountMany, eytzinger_set<1 << 18>, 1 << 18)->Arg(16)->Arg(256);
+BENCHMARK_TEMPLATE(BM_IntCount, stree_set<1 << 10>, 1 << 10);
+BENCHMARK_TEMPLATE(BM_IntCount, stree_set<1 << 16>, 1 << 16);
+BENCHMARK_TEMPLATE(BM_IntCount, stree_set<1 << 18>, 1 << 18);
+BENCHMARK_TEMPLATE(BM_IntCount, learned_set<1 << 10>, 1 << 10);
+BENCHMARK_TEMPLATE(BM_IntCount, learned_set<1 << 16>, 1 << 16);
+BENCHMARK_TEMPLATE(BM_IntCount, learned_set<1 << 18>, 1 << 18);
+BENCHMARK_TEMPLATE(BM_IntCountSortedOneByOne, sorted_set<1 << 16>, 1 << 16)->Arg(256)->Arg(1 << 16);
+BENCHMARK_TEMPLATE(BM_IntCountSortedMany, sorted_set<1 << 16>, 1 << 16)->Arg(256)->Arg(1 << 16);
+BENCHMARK_TEMPLATE(BM_IntCountSorted, sorted_set<1 << 16>, 1 << 16)->Arg(256)->Arg(1 << 16);
+BENCHMARK_TEMPLATE(BM_IntCountSortedOneByOne, sorted_set<1 << 18>, 1 << 18)->Arg(256)->Arg(1 << 16);
+BENCHMARK_TEMPLATE(BM_IntCountSorted, sorted_set<1 << 18>, 1 << 18)->Arg(256)->Arg(1 << 16);
+
+// Same, with most keys close to zero
+BENCHMARK_TEMPLATE(BM_IntCount, sorted_set<1 << 16>, 1 << 16, skewed_keys);
+BENCHMARK_TEMPLATE(BM_IntCount, eytzinger_set<1 << 16>, 1 << 16, skewed_keys);
+BENCHMARK_TEMPLATE(BM_IntCount, learned_set<1 << 16>, 1 << 16, skewed_keys);
+
+// Few keys: compared all at once, against searched or hashed
+struct plain_less {
+  constexpr bool operator()(unsigned a, unsigned b) const { return a < b; }
+};
+
+struct plain_equal {
+  constexpr bool operator()(unsigned a, unsigned b) const { return a == b; }
+};
+
+template <std::size_t N>
+using searched_set = frozen::set<unsigned, N, plain_less>;
+
+template <std::size_t N>
+using scanned_unordered_set = frozen::unordered_set<unsigned, N>;
+
+template <std::size_t N>
+using hashed_set = frozen::unordered_set<unsigned, N, frozen::elsa<unsigned>, plain_equal>;
+
+#define TINY(N)                                                                \
+  BENCHMARK_TEMPLATE(BM_IntCount, sorted_set<N>, N);                           \
+  BENCHMARK_TEMPLATE(BM_IntCount, searched_set<N>, N);                         \
+  BENCHMARK_TEMPLATE(BM_IntCount, scanned_unordered_set<N>, N);                \
+  BENCHMARK_TEMPLATE(BM_IntCount, hashed_set<N>, N)
+
+TINY(8);
+TINY(16);
+TINY(32);
+TINY(64);
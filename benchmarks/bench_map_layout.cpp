@@ -0,0 +1,82 @@
+#include <benchmark/benchmark.h>
+
+#include <frozen/map.h>
+#include <frozen/unordered_map.h>
+
+#include <array>
+#include <functional>
+#include <memory>
+#include <random>
+#include <vector>
+
+// Maps of 128 byte values, with their keys next to their values or in an
+// array of their own, see frozen::soa_layout. Lookups read the first byte of
+// the value found. Maps are built at runtime, on the heap; their
+// constructors take items by value, which keeps N within the stack.
+
+using record = std::array<char, 128>;
+
+template <std::size_t N>
+using sorted_map = frozen::map<unsigned, record, N>;
+
+template <std::size_t N>
+using soa_map = frozen::map<unsigned, record, N, std::less<unsigned>, frozen::soa_layout>;
+
+template <std::size_t N>
+using hashed_map = frozen::unordered_map<unsigned, record, N>;
+
+template <std::size_t N>
+using soa_hashed_map = frozen::unordered_map<unsigned, record, N, frozen::elsa<unsigned>,
+                                             std::equal_to<unsigned>, frozen::hanov_pmh, frozen::soa_layout>;
+
+template <class Map, std::size_t N>
+struct map_data {
+  std::unique_ptr<Map> map;
+  std::vector<unsigned> queries;
+
+  static map_data const &get() {
+    static map_data const data;
+    return data;
+  }
+
+private:
+  map_data() {
+    std::unique_ptr<frozen::bits::carray<std::pair<unsigned, record>, N>> items(
+        new frozen::bits::carray<std::pair<unsigned, record>, N>);
+    for (unsigned i = 0; i < N; ++i) {
+      (*items)[i].first = 2 * i * 2654435761u;
+      (*items)[i].second.fill(char(i));
+    }
+    map.reset(new Map(*items));
+
+    // one query out of two is a miss
+    std::mt19937 gen(N);
+    queries.resize(1 << 16);
+    for (auto &q : queries)
+      q = (*items)[gen() % N].first + (gen() & 1);
+  }
+};
+
+template <class Map, std::size_t N>
+static void BM_MapLookup(benchmark::State& state) {
+  auto const &data = map_data<Map, N>::get();
+  for (auto _ : state) {
+    std::size_t sum = 0;
+    for (auto q : data.queries) {
+      auto const where = data.map->find(q);
+      if (where != data.map->end())
+        sum += where->second[0];
+    }
+    benchmark::DoNotOptimize(sum);
+  }
+  state.SetItemsProcessed(state.iterations() * data.queries.size());
+}
+
+BENCHMARK_TEMPLATE(BM_MapLookup, sorted_map<1 << 12>, 1 << 12);
+BENCHMARK_TEMPLATE(BM_MapLookup, soa_map<1 << 12>, 1 << 12);
+BENCHMARK_TEMPLATE(BM_MapLookup, sorted_map<1 << 13>, 1 << 13);
+BENCHMARK_TEMPLATE(BM_MapLookup, soa_map<1 << 13>, 1 << 13);
+BENCHMARK_TEMPLATE(BM_MapLookup, hashed_map<1 << 11>, 1 << 11);
+BENCHMARK_TEMPLATE(BM_MapLookup, soa_hashed_map<1 << 11>, 1 << 11);
+BENCHMARK_TEMPLATE(BM_MapLookup, hashed_map<1 << 12>, 1 << 12);
+BENCHMARK_TEMPLATE(BM_MapLookup, soa_hashed_map<1 << 12>, 1 << 12);
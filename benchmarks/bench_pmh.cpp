@@ -0,0 +1,219 @@
+#include <benchmark/benchmark.h>
+
+#include <frozen/crc_hash.h>
+#include <frozen/length_unordered_set.h>
+#include <frozen/random.h>
+#include <frozen/unordered_map.h>
+#include <frozen/unordered_set.h>
+#include <frozen/string.h>
+
+#include <functional>
+#include <utility>
+#include <vector>
+
+// Compares the perfect hashing policies of frozen::unordered_set
+
+#define KEYWORDS                                                  \
+    "auto",     "break",  "case",    "char",   "const",    "continue", \
+    "default",  "do",     "double",  "else",   "enum",     "extern",   \
+    "float",    "for",    "goto",    "if",     "int",      "long",     \
+    "register", "return", "short",   "signed", "sizeof",   "static",   \
+    "struct",   "switch", "typedef", "union",  "unsigned", "void",     \
+    "volatile", "while",  "inline"
+
+template <class Policy>
+using keyword_set = frozen::unordered_set<frozen::string, 33, frozen::elsa<frozen::string>,
+                                          std::equal_to<frozen::string>, Policy>;
+
+static constexpr keyword_set<frozen::hanov_pmh> HanovKeywords{KEYWORDS};
+static constexpr keyword_set<frozen::minimal_pmh> MinimalKeywords{KEYWORDS};
+static constexpr keyword_set<frozen::pthash_pmh> PthashKeywords{KEYWORDS};
+static constexpr keyword_set<frozen::slot_ordered_pmh> SlotOrderedKeywords{KEYWORDS};
+static constexpr keyword_set<frozen::block_pmh> BlockKeywords{KEYWORDS};
+static constexpr keyword_set<frozen::fingerprint_pmh<frozen::hanov_pmh>> FingerprintKeywords{KEYWORDS};
+static constexpr frozen::unordered_set<frozen::string, 33, frozen::crc_hash<frozen::string>>
+    CrcKeywords{KEYWORDS};
+
+static constexpr frozen::length_unordered_set<33> LengthKeywords{KEYWORDS};
+
+static const frozen::string SomeKeywords[33] = {KEYWORDS};
+static auto const * volatile SomeKeywordsPtr = &SomeKeywords;
+
+static const frozen::string SomeStrings[33] = {
+    "auto0",     "break0",  "case0",    "char0",   "const0",    "continue0",
+    "default0",  "do0",     "double0",  "else0",   "enum0",     "extern0",
+    "float0",    "for0",    "goto0",    "if0",     "int0",      "long0",
+    "register0", "return0", "short0",   "signed0", "sizeof0",   "static0",
+    "struct0",   "switch0", "typedef0", "union0",  "unsigned0", "void0",
+    "volatile0", "while0",  "inline0"};
+static auto const * volatile SomeStringsPtr = &SomeStrings;
+
+template <class Set>
+static void lookup_all(benchmark::State& state, Set const& set, frozen::string const (&queries)[33]) {
+  for (auto _ : state) {
+    for(auto kw : queries) {
+      volatile bool status = set.count(kw);
+      (void)status;
+    }
+  }
+  state.counters["bytes"] = sizeof(set);
+}
+
+static void BM_StrInHanovPmh(benchmark::State& state) {
+  lookup_all(state, HanovKeywords, *SomeKeywordsPtr);
+}
+BENCHMARK(BM_StrInHanovPmh);
+
+static void BM_StrInMinimalPmh(benchmark::State& state) {
+  lookup_all(state, MinimalKeywords, *SomeKeywordsPtr);
+}
+BENCHMARK(BM_StrInMinimalPmh);
+
+static void BM_StrInPthashPmh(benchmark::State& state) {
+  lookup_all(state, PthashKeywords, *SomeKeywordsPtr);
+}
+BENCHMARK(BM_StrInPthashPmh);
+
+static void BM_StrInSlotOrderedPmh(benchmark::State& state) {
+  lookup_all(state, SlotOrderedKeywords, *SomeKeywordsPtr);
+}
+BENCHMARK(BM_StrInSlotOrderedPmh);
+
+static void BM_StrInBlockPmh(benchmark::State& state) {
+  lookup_all(state, BlockKeywords, *SomeKeywordsPtr);
+}
+BENCHMARK(BM_StrInBlockPmh);
+
+static void BM_StrInFingerprintPmh(benchmark::State& state) {
+  lookup_all(state, FingerprintKeywords, *SomeKeywordsPtr);
+}
+BENCHMARK(BM_StrInFingerprintPmh);
+
+static void BM_StrInCrcHash(benchmark::State& state) {
+  lookup_all(state, CrcKeywords, *SomeKeywordsPtr);
+}
+BENCHMARK(BM_StrInCrcHash);
+
+static void BM_StrInLengthSet(benchmark::State& state) {
+  lookup_all(state, LengthKeywords, *SomeKeywordsPtr);
+}
+BENCHMARK(BM_StrInLengthSet);
+
+static void BM_StrNotInHanovPmh(benchmark::State& state) {
+  lookup_all(state, HanovKeywords, *SomeStringsPtr);
+}
+BENCHMARK(BM_StrNotInHanovPmh);
+
+static void BM_StrNotInMinimalPmh(benchmark::State& state) {
+  lookup_all(state, MinimalKeywords, *SomeStringsPtr);
+}
+BENCHMARK(BM_StrNotInMinimalPmh);
+
+static void BM_StrNotInPthashPmh(benchmark::State& state) {
+  lookup_all(state, PthashKeywords, *SomeStringsPtr);
+}
+BENCHMARK(BM_StrNotInPthashPmh);
+
+static void BM_StrNotInSlotOrderedPmh(benchmark::State& state) {
+  lookup_all(state, SlotOrderedKeywords, *SomeStringsPtr);
+}
+BENCHMARK(BM_StrNotInSlotOrderedPmh);
+
+static void BM_StrNotInBlockPmh(benchmark::State& state) {
+  lookup_all(state, BlockKeywords, *SomeStringsPtr);
+}
+BENCHMARK(BM_StrNotInBlockPmh);
+
+static void BM_StrNotInFingerprintPmh(benchmark::State& state) {
+  lookup_all(state, FingerprintKeywords, *SomeStringsPtr);
+}
+BENCHMARK(BM_StrNotInFingerprintPmh);
+
+static void BM_StrNotInCrcHash(benchmark::State& state) {
+  lookup_all(state, CrcKeywords, *SomeStringsPtr);
+}
+BENCHMARK(BM_StrNotInCrcHash);
+
+static void BM_StrNotInLengthSet(benchmark::State& state) {
+  lookup_all(state, LengthKeywords, *SomeStringsPtr);
+}
+BENCHMARK(BM_StrNotInLengthSet);
+
+// Long keys, told apart by a couple of their bytes
+#define URLS                                                                   \
+    "https://example.com/api/v1/users/profile",                               \
+    "https://example.com/api/v1/users/settings",                              \
+    "https://example.com/api/v1/groups/members",                              \
+    "https://example.com/api/v1/groups/settings",                             \
+    "https://example.com/api/v2/users/profile",                               \
+    "https://example.com/api/v2/users/settings",                              \
+    "https://example.com/api/v2/groups/members",                              \
+    "https://example.com/api/v2/groups/settings",                             \
+    "https://example.com/static/css/main.css",                                \
+    "https://example.com/static/js/main.js",                                  \
+    "https://example.com/static/img/logo.png",                                \
+    "https://example.com/static/img/favicon.ico"
+
+static constexpr frozen::unordered_set<frozen::string, 12> HanovUrls{URLS};
+static constexpr frozen::unordered_set<frozen::string, 12, frozen::elsa<frozen::string>,
+                                       std::equal_to<frozen::string>, frozen::key_position_pmh<>>
+    KeyPositionUrls{URLS};
+
+static const frozen::string SomeUrls[12] = {URLS};
+static auto const * volatile SomeUrlsPtr = &SomeUrls;
+
+template <class Set>
+static void lookup_urls(benchmark::State& state, Set const& set) {
+  for (auto _ : state) {
+    for(auto url : *SomeUrlsPtr) {
+      volatile bool status = set.count(url);
+      (void)status;
+    }
+  }
+}
+
+static constexpr frozen::length_unordered_set<12> LengthUrls{URLS};
+
+static void BM_UrlInHanovPmh(benchmark::State& state) {
+  lookup_urls(state, HanovUrls);
+}
+BENCHMARK(BM_UrlInHanovPmh);
+
+static void BM_UrlInKeyPositionPmh(benchmark::State& state) {
+  lookup_urls(state, KeyPositionUrls);
+}
+BENCHMARK(BM_UrlInKeyPositionPmh);
+
+static void BM_UrlInLengthSet(benchmark::State& state) {
+  lookup_urls(state, LengthUrls);
+}
+BENCHMARK(BM_UrlInLengthSet);
+
+// Cold cache lookups: copies of a map spanning state.range(0) MiB are queried
+// in random order, so with a working set larger than the last level cache
+// most lookups miss on every table they touch.
+template <class Policy>
+static void BM_IntColdLookup(benchmark::State& state) {
+  using map_type = frozen::unordered_map<unsigned, unsigned, 1024, frozen::elsa<unsigned>,
+                                         std::equal_to<unsigned>, Policy>;
+  frozen::bits::carray<std::pair<unsigned, unsigned>, 1024> items;
+  for (unsigned i = 0; i < 1024; ++i)
+    items[i] = {i * 2654435761u, i};
+  map_type const map{items, frozen::elsa<unsigned>{}, std::equal_to<unsigned>{}};
+
+  std::size_t const copies = (static_cast<std::size_t>(state.range(0)) << 20) / sizeof(map_type) + 1;
+  std::vector<map_type> maps(copies, map);
+
+  frozen::default_prg_t prg;
+  for (auto _ : state) {
+    auto const r = prg();
+    // one query out of two is a miss
+    unsigned const key = items[r % 1024].first + static_cast<unsigned>((r >> 10) & 1);
+    benchmark::DoNotOptimize(maps[(r >> 11) % copies].count(key));
+  }
+  state.counters["bytes"] = sizeof(map_type);
+}
+BENCHMARK_TEMPLATE(BM_IntColdLookup, frozen::hanov_pmh)->Arg(1)->Arg(512);
+BENCHMARK_TEMPLATE(BM_IntColdLookup, frozen::slot_ordered_pmh)->Arg(1)->Arg(512);
+BENCHMARK_TEMPLATE(BM_IntColdLookup, frozen::pthash_pmh)->Arg(1)->Arg(512);
+BENCHMARK_TEMPLATE(BM_IntColdLookup, frozen::block_pmh)->Arg(1)->Arg(512);
@@ -0,0 +1,45 @@
+#include <benchmark/benchmark.h>
+
+#include <frozen/runtime_unordered_map.h>
+
+#include <cstdint>
+#include <random>
+#include <vector>
+
+// Build throughput and size of frozen::runtime_unordered_map
+
+static std::vector<std::pair<std::uint64_t, std::uint32_t>> random_items(std::size_t n) {
+  std::mt19937_64 gen(n);
+  std::vector<std::pair<std::uint64_t, std::uint32_t>> items;
+  items.reserve(n);
+  for (std::size_t i = 0; i < n; ++i)
+    items.emplace_back(gen(), static_cast<std::uint32_t>(i));
+  return items;
+}
+
+static void BM_RuntimeMapBuild(benchmark::State& state) {
+  auto const items = random_items(state.range(0));
+  std::size_t bits = 0;
+  for (auto _ : state) {
+    frozen::runtime_unordered_map<std::uint64_t, std::uint32_t> map(items);
+    bits = map.function_bit_size();
+    benchmark::DoNotOptimize(map);
+  }
+  state.counters["keys/s"] = benchmark::Counter(static_cast<double>(items.size()) * state.iterations(),
+                                                benchmark::Counter::kIsRate);
+  state.counters["bits/key"] = static_cast<double>(bits) / items.size();
+}
+BENCHMARK(BM_RuntimeMapBuild)
+  ->Arg(1 << 16)->Arg(1 << 20)->Arg(10 << 20)
+  ->Unit(benchmark::kMillisecond)->Iterations(1);
+
+static void BM_RuntimeMapLookup(benchmark::State& state) {
+  auto const items = random_items(state.range(0));
+  frozen::runtime_unordered_map<std::uint64_t, std::uint32_t> map(items);
+  std::size_t i = 0;
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(map.find(items[i].first));
+    i = (i + 1) % items.size();
+  }
+}
+BENCHMARK(BM_RuntimeMapLookup)->Arg(1 << 16)->Arg(1 << 20);
@@ -0,0 +1,31 @@
+#include <benchmark/benchmark.h>
+
+#include <frozen/crc_hash.h>
+#include <frozen/string.h>
+
+#include <string>
+#include <vector>
+
+// String hashers on keys of state.range(0) bytes. crc_hash only uses the
+// crc32 instruction when built for it, e.g. with -msse4.2.
+
+static std::vector<std::string> make_keys(std::size_t size) {
+  std::vector<std::string> keys(64);
+  for (std::size_t i = 0; i < keys.size(); ++i)
+    for (std::size_t j = 0; j < size; ++j)
+      keys[i] += static_cast<char>('a' + (i * 7 + j * 13) % 26);
+  return keys;
+}
+
+template <class Hasher>
+static void BM_StrHash(benchmark::State& state) {
+  auto const keys = make_keys(static_cast<std::size_t>(state.range(0)));
+  Hasher const hasher{};
+  for (auto _ : state) {
+    for (auto const &key : keys)
+      benchmark::DoNotOptimize(hasher(frozen::string{key.data(), key.size()}, 0x1234));
+  }
+  state.SetItemsProcessed(state.iterations() * keys.size());
+}
+BENCHMARK_TEMPLATE(BM_StrHash, frozen::elsa<frozen::string>)->Arg(8)->Arg(24)->Arg(60);
+BENCHMARK_TEMPLATE(BM_StrHash, frozen::crc_hash<frozen::string>)->Arg(8)->Arg(24)->Arg(60);
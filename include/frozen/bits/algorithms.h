@@ -24,9 +24,15 @@
 #define FROZEN_LETITGO_BITS_ALGORITHMS_H
 
 #include "frozen/bits/basic_types.h"
+#include "frozen/bits/prefetch.h"
 
+#include <cstdint>
+#include <functional>
+#include <iterator>
 #include <limits>
 #include <tuple>
+#include <type_traits>
+#include <utility>
 
 namespace frozen {
 
@@ -53,12 +59,16 @@ auto constexpr log(T v) {
 }
 
 constexpr std::size_t bit_weight(std::size_t n) {
-  return (n <= 8*sizeof(unsigned int))
+  return (n <= 8*sizeof(unsigned char))
+    + (n <= 8*sizeof(unsigned short))
+    + (n <= 8*sizeof(unsigned int))
     + (n <= 8*sizeof(unsigned long))
     + (n <= 8*sizeof(unsigned long long))
     + (n <= 128);
 }
 
+unsigned char select_uint_least(std::integral_constant<std::size_t, 6>);
+unsigned short select_uint_least(std::integral_constant<std::size_t, 5>);
 unsigned int select_uint_least(std::integral_constant<std::size_t, 4>);
 unsigned long select_uint_least(std::integral_constant<std::size_t, 3>);
 unsigned long long select_uint_least(std::integral_constant<std::size_t, 2>);
@@ -72,6 +82,23 @@ unsigned long long select_uint_least(std::integral_constant<std::size_t, N>) {
 template<std::size_t N>
 using select_uint_least_t = decltype(select_uint_least(std::integral_constant<std::size_t, bit_weight(N)>()));
 
+// Finalizer of MurmurHash3, spreads every input bit over the whole word
+constexpr uint64_t mix64(uint64_t h) {
+  h ^= h >> 33;
+  h *= 0xff51afd7ed558ccdULL;
+  h ^= h >> 33;
+  h *= 0xc4ceb9fe1a85ec53ULL;
+  h ^= h >> 33;
+  return h;
+}
+
+// Maps the high bits of a hash to [0, n) with a multiplication instead of a
+// modulo, see https://lemire.me/blog/2016/06/27/a-fast-alternative-to-the-modulo-reduction/
+// n must fit in 32 bits.
+constexpr std::size_t fastrange(uint64_t h, std::size_t n) {
+  return static_cast<std::size_t>(((h >> 32) * static_cast<uint64_t>(n)) >> 32);
+}
+
 template <typename Iter, typename Compare>
 constexpr auto min_element(Iter begin, const Iter end,
                            Compare const &compare) {
@@ -87,9 +114,9 @@ constexpr auto min_element(Iter begin, const Iter end,
 
 template <class T>
 constexpr void cswap(T &a, T &b) {
-  auto tmp = a;
-  a = b;
-  b = tmp;
+  auto tmp = std::move(a);
+  a = std::move(b);
+  b = std::move(tmp);
 }
 
 template <class T, class U>
@@ -109,36 +136,158 @@ constexpr void cswap(std::tuple<Tys...> &a, std::tuple<Tys...> &b) {
   cswap(a, b, std::make_index_sequence<sizeof...(Tys)>());
 }
 
-template <typename Iterator, class Compare>
-constexpr Iterator partition(Iterator left, Iterator right, Compare const &compare) {
-  auto pivot = left + (right - left) / 2;
-  auto value = *pivot;
-  cswap(*right, *pivot);
-  for (auto it = left; 0 < right - it; ++it) {
-    if (compare(*it, value)) {
-      cswap(*it, *left);
-      left++;
-    }
+// Assignment, through the members of pairs and tuples, whose own assignment
+// is not constexpr before C++20
+template <class T>
+constexpr void cassign(T &a, T const &b) {
+  a = b;
+}
+
+template <class T, class U>
+constexpr void cassign(std::pair<T, U> &a, std::pair<T, U> const &b) {
+  cassign(a.first, b.first);
+  cassign(a.second, b.second);
+}
+
+template <class... Tys, std::size_t... Is>
+constexpr void cassign(std::tuple<Tys...> &a, std::tuple<Tys...> const &b, std::index_sequence<Is...>) {
+  using swallow = int[];
+  (void) swallow{(cassign(std::get<Is>(a), std::get<Is>(b)), 0)...};
+}
+
+template <class... Tys>
+constexpr void cassign(std::tuple<Tys...> &a, std::tuple<Tys...> const &b) {
+  cassign(a, b, std::make_index_sequence<sizeof...(Tys)>());
+}
+
+// Returns the array whose i-th element is items[order[i]]
+template <class T, std::size_t N, std::size_t... Is>
+constexpr carray<T, N> permute(carray<T, N> const &items,
+                               carray<std::size_t, N> const &order,
+                               std::index_sequence<Is...>) {
+  return carray<T, N>{items[order[Is]]...};
+}
+
+template <class T, std::size_t N>
+constexpr carray<T, N> permute(carray<T, N> const &items,
+                               carray<std::size_t, N> const &order) {
+  return permute(items, order, std::make_index_sequence<N>());
+}
+
+// Sorts [first, last) by shifting larger items right, for short ranges
+template <class Iterator, class Compare>
+constexpr void insertion_sort(Iterator first, Iterator last, Compare const &compare) {
+  for (auto it = first + 1; it < last; ++it) {
+    if (!compare(*it, *(it - 1)))
+      continue;
+    auto value = *it;
+    auto hole = it;
+    do {
+      cassign(*hole, *(hole - 1));
+      --hole;
+    } while (hole != first && compare(value, *(hole - 1)));
+    cassign(*hole, value);
   }
-  cswap(*right, *left);
-  return left;
 }
 
-template <typename Iterator, class Compare>
-constexpr void quicksort(Iterator left, Iterator right, Compare const &compare) {
-  while (0 < right - left) {
-    auto new_pivot = bits::partition(left, right, compare);
-    quicksort(left, new_pivot, compare);
-    left = new_pivot + 1;
+template <class Iterator, class Compare>
+constexpr void sift_down(Iterator first, std::ptrdiff_t root, std::ptrdiff_t size, Compare const &compare) {
+  for (auto child = 2 * root + 1; child < size; root = child, child = 2 * root + 1) {
+    if (child + 1 < size && compare(*(first + child), *(first + (child + 1))))
+      ++child;
+    if (!compare(*(first + root), *(first + child)))
+      return;
+    cswap(*(first + root), *(first + child));
   }
 }
 
-template <typename T, std::size_t N, class Compare>
-constexpr bits::carray<T, N> quicksort(bits::carray<T, N> const &array,
-                                     Compare const &compare) {
-  bits::carray<T, N> res = array;
-  quicksort(res.begin(), res.end() - 1, compare);
-  return res;
+template <class Iterator, class Compare>
+constexpr void heap_sort(Iterator first, Iterator last, Compare const &compare) {
+  auto const size = last - first;
+  for (auto root = size / 2; root > 0; --root)
+    sift_down(first, root - 1, size, compare);
+  for (auto end = size - 1; end > 0; --end) {
+    cswap(*first, *(first + end));
+    sift_down(first, 0, end, compare);
+  }
+}
+
+// Splits [first, last), of at least three items, around the median of its
+// first, middle and last items: returns split such that no item of
+// [first, split) is greater than the pivot, and no item of [split, last) is
+// lower. Both sides are non empty; the outer items bound the scans.
+template <class Iterator, class Compare>
+constexpr Iterator partition(Iterator first, Iterator last, Compare const &compare) {
+  auto mid = first + (last - first) / 2;
+  auto back = last - 1;
+  if (compare(*mid, *first))
+    cswap(*mid, *first);
+  if (compare(*back, *mid)) {
+    cswap(*back, *mid);
+    if (compare(*mid, *first))
+      cswap(*mid, *first);
+  }
+  auto const pivot = *mid;
+  auto left = first, right = back;
+  while (true) {
+    do
+      ++left;
+    while (compare(*left, pivot));
+    do
+      --right;
+    while (compare(pivot, *right));
+    if (!(left < right))
+      return left;
+    cswap(*left, *right);
+  }
+}
+
+// Range of an introsort, as offsets, and the partitions it may still take
+// before falling back to a heap sort
+struct sort_range {
+  std::ptrdiff_t first = 0;
+  std::ptrdiff_t last = 0;
+  std::size_t depth = 0;
+};
+
+// Introsort without recursion, so that constant evaluation stays within the
+// depth limit of compilers: the larger side of every partition waits on a
+// stack while the smaller one is sorted, which bounds the stack to log2 of
+// the size. Short ranges are insertion sorted, and ranges that partition
+// badly are heap sorted.
+template <class Iterator, class Compare>
+constexpr void introsort(Iterator first, Iterator last, Compare const &compare) {
+  constexpr std::ptrdiff_t short_range = 16;
+  carray<sort_range, 8 * sizeof(std::size_t)> pending;
+  std::size_t waiting = 0;
+  sort_range range;
+  range.last = last - first;
+  range.depth = 2 * log(static_cast<std::size_t>(range.last) + 1);
+  while (true) {
+    while (range.last - range.first > short_range) {
+      if (range.depth == 0) {
+        heap_sort(first + range.first, first + range.last, compare);
+        range.last = range.first;
+        break;
+      }
+      --range.depth;
+      auto const split = bits::partition(first + range.first, first + range.last, compare) - first;
+      auto other = range;
+      if (split - range.first < range.last - split) {
+        other.first = split;
+        range.last = split;
+      } else {
+        other.last = split;
+        range.first = split;
+      }
+      pending[waiting++] = other;
+    }
+    if (range.last - range.first > 1)
+      insertion_sort(first + range.first, first + range.last, compare);
+    if (!waiting)
+      return;
+    range = pending[--waiting];
+  }
 }
 
 template <class T, class Compare> struct LowerBound {
@@ -199,6 +348,286 @@ constexpr bool binary_search(ForwardIt first, const T &value,
   return (!(where == first + N) && !(compare(value, *where)));
 }
 
+// Maps an integer or an enum to an unsigned 64 bit value, preserving order
+template <class T>
+constexpr uint64_t dense_ordinal(T value, std::false_type /* enum */) {
+  return std::is_signed<T>::value
+             ? static_cast<uint64_t>(static_cast<int64_t>(value)) ^ (uint64_t(1) << 63)
+             : static_cast<uint64_t>(value);
+}
+
+template <class T>
+constexpr uint64_t dense_ordinal(T value, std::true_type /* enum */) {
+  return dense_ordinal(static_cast<std::underlying_type_t<T>>(value), std::false_type{});
+}
+
+template <class T>
+constexpr uint64_t dense_ordinal(T value) {
+  return dense_ordinal(value, std::is_enum<T>{});
+}
+
+// Sorted containers whose keys are integers or enums in their natural order
+// may find a key from its distance to the first key instead of searching.
+template <class Key, class Compare>
+using is_dense_searchable =
+    std::integral_constant<bool, (std::is_integral<Key>::value || std::is_enum<Key>::value) &&
+                                     std::is_same<Compare, std::less<Key>>::value>;
+
+// Key of a set or map item
+struct item_key {
+  template <class T>
+  constexpr T const &operator()(T const &key) const { return key; }
+  template <class K, class V>
+  constexpr K const &operator()(std::pair<K, V> const &item) const { return item.first; }
+};
+
+// LSD radix sort of items by the dense_ordinal of their integer or enum key.
+// Keys are ranked from the smallest one, so that only the bits that differ
+// between keys take a pass. These bits are split into digits of equal width,
+// at most about log2(N) and 16 bits, so that the counts cost no more than
+// the items. Linear in N, where comparison sorts take N log N steps of
+// constant evaluation.
+template <class T, std::size_t N, class KeyOf>
+constexpr carray<T, N> radix_sort(carray<T, N> const &items, KeyOf const &key_of) {
+  constexpr std::size_t max_digit_bits = log(N) < 6 ? 8 : log(N) > 14 ? 16 : log(N) + 2;
+
+  carray<uint64_t, N> ranks;
+  uint64_t lowest = dense_ordinal(key_of(items[0]));
+  for (std::size_t i = 0; i < N; ++i) {
+    ranks[i] = dense_ordinal(key_of(items[i]));
+    lowest = ranks[i] < lowest ? ranks[i] : lowest;
+  }
+  uint64_t spread = 0;
+  for (std::size_t i = 0; i < N; ++i) {
+    ranks[i] -= lowest;
+    spread |= ranks[i];
+  }
+
+  std::size_t bits = 0;
+  while (bits < 64 && (spread >> bits))
+    ++bits;
+  std::size_t const passes = (bits + max_digit_bits - 1) / max_digit_bits;
+  std::size_t const digit_bits = passes ? (bits + passes - 1) / passes : 1;
+  std::size_t const digits = std::size_t(1) << digit_bits;
+
+  carray<T, N> sorted = items;
+  carray<T, N> buffer = items;
+  carray<uint64_t, N> rank_buffer = ranks;
+  carray<T, N> *from = &sorted;
+  carray<T, N> *to = &buffer;
+  carray<uint64_t, N> *from_ranks = &ranks;
+  carray<uint64_t, N> *to_ranks = &rank_buffer;
+  for (std::size_t shift = 0; shift < 64 && (spread >> shift); shift += digit_bits) {
+    carray<std::size_t, std::size_t(1) << max_digit_bits> count;
+    for (std::size_t i = 0; i < N; ++i)
+      ++count[((*from_ranks)[i] >> shift) & (digits - 1)];
+    std::size_t offset = 0;
+    for (std::size_t digit = 0; digit < digits; ++digit) {
+      auto const size = count[digit];
+      count[digit] = offset;
+      offset += size;
+    }
+    for (std::size_t i = 0; i < N; ++i) {
+      auto const at = count[((*from_ranks)[i] >> shift) & (digits - 1)]++;
+      cassign((*to)[at], (*from)[i]);
+      (*to_ranks)[at] = (*from_ranks)[i];
+    }
+    auto *const items_done = from;
+    from = to;
+    to = items_done;
+    auto *const ranks_done = from_ranks;
+    from_ranks = to_ranks;
+    to_ranks = ranks_done;
+  }
+  return *from;
+}
+
+// Whether compare orders keys of type Key as operator< does
+template <class Compare, class Key>
+struct is_natural_order : std::is_same<Compare, std::less<Key>> {};
+
+// Below this many items, the counts of radix_sort cost more than they save
+constexpr std::size_t radix_sort_min = 64;
+
+template <class T, std::size_t N, class Compare>
+constexpr carray<T, N> sort(carray<T, N> const &items, Compare const &,
+                            std::true_type /* radix sortable */) {
+  return radix_sort(items, item_key{});
+}
+
+template <class T, std::size_t N, class Compare>
+constexpr carray<T, N> sort(carray<T, N> const &items, Compare const &compare,
+                            std::false_type /* radix sortable */) {
+  carray<T, N> sorted = items;
+  introsort(sorted.begin(), sorted.end(), compare);
+  return sorted;
+}
+
+// Sorted copy of the items of a set or map: a radix sort for integer and
+// enum keys in their natural order, an introsort otherwise
+template <class T, std::size_t N, class Compare>
+constexpr carray<T, N> sort(carray<T, N> const &items, Compare const &compare) {
+  using key_type = std::decay_t<decltype(item_key{}(std::declval<T const &>()))>;
+  using radix_sortable =
+      std::integral_constant<bool, (std::is_integral<key_type>::value || std::is_enum<key_type>::value) &&
+                                       is_natural_order<Compare, key_type>::value && N >= radix_sort_min>;
+  return sort(items, compare, radix_sortable{});
+}
+
+// Beyond this many holes, a binary search beats the scan of dense_find
+constexpr uint64_t dense_max_holes = 8;
+
+// Holes of N sorted integer keys: the values between the first and the last
+// key that are not keys. Keys that are not distinct, which dense_find cannot
+// tell apart, count as more than dense_max_holes, as do keys of containers
+// that are not dense searchable.
+template <std::size_t N, class RandomIt, class KeyOf>
+constexpr uint64_t dense_holes(RandomIt first, KeyOf const &key_of, std::true_type /* dense searchable */) {
+  for (std::size_t i = 1; i < N; ++i)
+    if (!(key_of(*(first + (i - 1))) < key_of(*(first + i))))
+      return dense_max_holes + 1;
+  return N ? dense_ordinal(key_of(*(first + (N - 1)))) - dense_ordinal(key_of(*first)) - (N - 1) : 0;
+}
+
+template <std::size_t N, class RandomIt, class KeyOf>
+constexpr uint64_t dense_holes(RandomIt, KeyOf const &, std::false_type /* dense searchable */) {
+  return dense_max_holes + 1;
+}
+
+// Holes of the keys of a container, kept only when they are dense searchable:
+// containers derive from it, so that it takes no room otherwise.
+template <bool Dense>
+class dense_hole_count {
+  uint64_t holes_;
+
+public:
+  constexpr explicit dense_hole_count(uint64_t holes) : holes_(holes) {}
+  constexpr uint64_t holes() const { return holes_; }
+};
+
+template <>
+class dense_hole_count<false> {
+public:
+  constexpr explicit dense_hole_count(uint64_t) {}
+  constexpr uint64_t holes() const { return dense_max_holes + 1; }
+};
+
+// Finds key among N sorted, distinct integer keys with the given holes, or
+// returns first + N. The index of a key is at most its distance d to the
+// first key, and at least d - holes, so only that window is scanned. Without
+// holes, the index is d.
+template <std::size_t N, class RandomIt, class T, class KeyOf>
+constexpr RandomIt dense_find(RandomIt first, T const &key, uint64_t holes, KeyOf const &key_of) {
+  auto const distance = dense_ordinal(key) - dense_ordinal(key_of(*first));
+  if (distance > N - 1 + holes)
+    return first + N;
+  if (holes == 0)
+    return key_of(*(first + distance)) == key ? first + distance : first + N;
+  auto const last = distance < N - 1 ? distance : N - 1;
+  for (auto index = distance > holes ? distance - holes : 0; index <= last; ++index)
+    if (key_of(*(first + index)) == key)
+      return first + index;
+  return first + N;
+}
+
+
+// Runs lower_bound<N>(base, *it, compare) for every key of [first, last), and
+// calls f(*it, where) in order. The searches of a group of keys advance in
+// lockstep, each step prefetching the next probe of every key, so that their
+// cache misses overlap.
+template <std::size_t N, class RandomIt, class ForwardIt, class Compare, class F>
+void lower_bound_many(RandomIt base, ForwardIt first, ForwardIt last,
+                      Compare const &compare, F &&f) {
+  constexpr std::size_t group = 16;
+  RandomIt where[group];
+  while (first != last) {
+    std::size_t n = 0;
+    for (auto it = first; n < group && it != last; ++it, ++n) {
+      where[n] = base;
+      if (N > 1)
+        FROZEN_PREFETCH(&*(base + (N / 2 - 1)));
+    }
+
+    // Branchless search, the answer stays in [where, where + len]
+    std::size_t len = N;
+    while (len > 1) {
+      auto const half = len / 2;
+      auto it = first;
+      for (std::size_t i = 0; i < n; ++i, ++it) {
+        if (compare(*(where[i] + (half - 1)), *it))
+          where[i] += half;
+        if (len - half > 1)
+          FROZEN_PREFETCH(&*(where[i] + ((len - half) / 2 - 1)));
+      }
+      len -= half;
+    }
+
+    for (std::size_t i = 0; i < n; ++i, ++first) {
+      if (N > 0 && compare(*where[i], *first))
+        ++where[i];
+      f(*first, where[i]);
+    }
+  }
+}
+
+// Runs lower_bound<N>(base, *it, compare) for every key of [first, last), and
+// calls f(*it, where) in order. Keys are expected in ascending order: the
+// search of a key gallops from the answer to the previous one, doubling its
+// steps, then bisects the last step, so that close keys cost few probes and
+// memory is read forward. The first step is the expected distance between
+// the answers, N / (last - first), when the number of keys is known. A key
+// lower than the previous one restarts from base.
+template <std::size_t N, class RandomIt, class InputIt, class Compare, class F>
+void lower_bound_sorted(RandomIt base, InputIt first, InputIt last, Compare const &compare,
+                        F &&f, std::size_t gap) {
+  std::size_t pos = 0;
+  for (; first != last; ++first) {
+    auto const &key = *first;
+    if (pos > 0 && !compare(*(base + (pos - 1)), key))
+      pos = 0;
+
+    // items before low are lower than key, the answer is in [low, high]
+    std::size_t low = pos, high = pos, step = gap;
+    while (high < N && compare(*(base + high), key)) {
+      low = high + 1;
+      high = N - low > step - 1 ? low + step - 1 : N;
+      step *= 2;
+    }
+
+    // branchless bisection of [low, high], see lower_bound_many
+    auto where = base + low;
+    std::size_t len = high - low;
+    while (len > 1) {
+      auto const half = len / 2;
+      if (compare(*(where + (half - 1)), key))
+        where += half;
+      len -= half;
+    }
+    if (len && compare(*where, key))
+      ++where;
+    pos = static_cast<std::size_t>(where - base);
+    f(key, where);
+  }
+}
+
+template <std::size_t N, class RandomIt, class InputIt, class Compare, class F>
+void lower_bound_sorted(RandomIt base, InputIt first, InputIt last, Compare const &compare, F &&f,
+                        std::input_iterator_tag) {
+  lower_bound_sorted<N>(base, first, last, compare, f, 1);
+}
+
+template <std::size_t N, class RandomIt, class ForwardIt, class Compare, class F>
+void lower_bound_sorted(RandomIt base, ForwardIt first, ForwardIt last, Compare const &compare, F &&f,
+                        std::forward_iterator_tag) {
+  auto const keys = static_cast<std::size_t>(std::distance(first, last));
+  lower_bound_sorted<N>(base, first, last, compare, f, keys < N ? N / (keys + 1) : 1);
+}
+
+template <std::size_t N, class RandomIt, class InputIt, class Compare, class F>
+void lower_bound_sorted(RandomIt base, InputIt first, InputIt last, Compare const &compare, F &&f) {
+  lower_bound_sorted<N>(base, first, last, compare, f,
+                        typename std::iterator_traits<InputIt>::iterator_category{});
+}
 
 template<class InputIt1, class InputIt2>
 constexpr bool equal(InputIt1 first1, InputIt1 last1, InputIt2 first2)
@@ -0,0 +1,228 @@
+/*
+ * Frozen
+ * Copyright 2016 QuarksLab
+ *
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+// Cache line sized buckets: everything needed to resolve a key, short of
+// comparing it, is read from a single 64 byte block.
+#ifndef FROZEN_LETITGO_BLOCK_PMH_H
+#define FROZEN_LETITGO_BLOCK_PMH_H
+
+#include "frozen/bits/algorithms.h"
+#include "frozen/bits/basic_types.h"
+#include "frozen/bits/pmh.h"
+
+#include <cstdint>
+
+namespace frozen {
+
+namespace bits {
+
+// A bucket of keys. When a block is full, the keys hashed to it go to the
+// next block with room, and the block is marked as overflowing so that
+// lookups follow them. The seed of the block is chosen so that the
+// fingerprints of its keys, and of the keys going through it, are distinct:
+// a key thus matches at most one entry on its way.
+// Blocks are 64 bytes, but not aligned to cache lines: operator new ignores
+// over-aligned types before C++17, and containers may live on the heap. The
+// same goes for the nodes of stree_array.
+template <class Index>
+struct pmh_block {
+  static constexpr std::size_t capacity = (64 - 4) / (1 + sizeof(Index));
+
+  uint8_t seed;
+  uint8_t size;
+  bool overflow;
+  uint8_t unused; // pads the block to 64 bytes
+  carray<uint8_t, capacity> fingerprints;
+  carray<Index, capacity> indices;
+};
+
+constexpr uint8_t pmh_block_fingerprint(uint64_t h, uint8_t seed) {
+  return static_cast<uint8_t>(pmh_remix(h, seed));
+}
+
+template <std::size_t N>
+struct pmh_block_sizes {
+  using index_type = select_uint_least_t<log(N) + 1>;
+  using block_type = pmh_block<index_type>;
+
+  // Blocks are filled to half of their capacity on average, few of them
+  // overflow.
+  static constexpr std::size_t blocks =
+      N ? (2 * N + block_type::capacity - 1) / block_type::capacity : 1;
+};
+
+// Represents the perfect hash function of the block layout. Returns N for keys
+// whose fingerprint matches no entry, which are then known to be absent.
+template <std::size_t N, class Hasher>
+struct pmh_block_tables {
+  using sizes = pmh_block_sizes<N>;
+  using index_type = typename sizes::index_type;
+  using block_type = typename sizes::block_type;
+
+  static constexpr std::size_t storage_size = sizes::blocks;
+
+  uint64_t seed_;
+  carray<block_type, sizes::blocks> blocks_;
+  Hasher hash_;
+
+  // Hashes a given key, once per lookup
+  template <typename KeyType>
+  constexpr uint64_t hash(const KeyType & key) const {
+    return static_cast<uint64_t>(hash_(key, static_cast<size_t>(seed_)));
+  }
+
+  // Prefetches the block of a key with hash h
+  void prefetch(uint64_t h) const {
+    FROZEN_PREFETCH(&blocks_[pmh_reduce<sizes::blocks>(static_cast<std::size_t>(h))]);
+  }
+
+  // Finds the expected index in carray<Item, N> of a key with hash h
+  constexpr std::size_t lookup_hash(uint64_t h) const {
+    auto b = pmh_reduce<sizes::blocks>(static_cast<std::size_t>(h));
+    while (true) {
+      auto const & block = blocks_[b];
+      auto const fingerprint = pmh_block_fingerprint(h, block.seed);
+      for (std::size_t i = 0; i < block.size; ++i)
+        if (block.fingerprints[i] == fingerprint)
+          return block.indices[i];
+      if (!block.overflow)
+        return N;
+      b = b + 1 == sizes::blocks ? 0 : b + 1;
+    }
+  }
+
+  // Looks up a given key, to find its expected index in carray<Item, N>
+  // Returns N or a valid index, must use KeyEqual test after to confirm.
+  template <typename KeyType>
+  constexpr std::size_t lookup(const KeyType & key) const {
+    return lookup_hash(hash(key));
+  }
+};
+
+// Called when no global seed gives distinct fingerprints to the keys of
+// every block, see pmh_bucket_phase_exceeded_budget.
+inline void pmh_block_phase_exceeded_budget() {
+  FROZEN_THROW_OR_ABORT(std::runtime_error("pmh: no seed fits the keys in blocks"));
+}
+
+// Make block tables for given items, hash function, prg, etc.
+// Gives up once Budget is exhausted, see pmh_budget.
+template <class Budget = pmh_default_budget, class Item, std::size_t N, class Hash,
+          class Key, class PRG>
+pmh_block_tables<N, Hash> constexpr make_pmh_block_tables(const carray<Item, N> &items,
+                                                          Hash const &hash,
+                                                          Key const &key, PRG prg) {
+  using tables_type = pmh_block_tables<N, Hash>;
+  using block_type = typename tables_type::block_type;
+  using index_type = typename tables_type::index_type;
+  constexpr std::size_t B = tables_type::sizes::blocks;
+  constexpr std::size_t max_seed = Budget::bucket_attempts < 256 ? Budget::bucket_attempts : 256;
+
+  // Continue until every block holds its keys with distinct fingerprints
+  for (std::size_t reseed = 0; reseed < Budget::reseeds; ++reseed) {
+    auto const seed = prg();
+
+    // Step 1: Hash every key once and place it in the first block with room,
+    // starting from its own. Keys stored past their own block are remembered,
+    // as they go through the blocks in between.
+    carray<uint64_t, N> hashes;
+    carray<block_type, B> blocks;
+    carray<std::size_t, N> displaced;
+    std::size_t displaced_count = 0;
+    for (std::size_t i = 0; i < N; ++i) {
+      hashes[i] = static_cast<uint64_t>(hash(key(items[i]), static_cast<size_t>(seed)));
+      auto b = pmh_reduce<B>(static_cast<std::size_t>(hashes[i]));
+      if (blocks[b].size == block_type::capacity)
+        displaced[displaced_count++] = i;
+      while (blocks[b].size == block_type::capacity) {
+        blocks[b].overflow = true;
+        b = b + 1 == B ? 0 : b + 1;
+      }
+      blocks[b].indices[blocks[b].size++] = static_cast<index_type>(i);
+    }
+
+    // Step 2: Find a seed giving distinct fingerprints to the keys of each
+    // block and to the displaced keys going through it
+    bool placed_all = true;
+    for (std::size_t b = 0; b < B && placed_all; ++b) {
+      auto & block = blocks[b];
+      bool placed = false;
+      for (std::size_t s = 0; s < max_seed && !placed; ++s) {
+        placed = true;
+        for (std::size_t i = 0; i < block.size && placed; ++i) {
+          auto const fingerprint = pmh_block_fingerprint(hashes[block.indices[i]], static_cast<uint8_t>(s));
+          for (std::size_t j = 0; j < i && placed; ++j)
+            placed = block.fingerprints[j] != fingerprint;
+          for (std::size_t d = 0; d < displaced_count && placed; ++d) {
+            auto const k = displaced[d];
+            if (k == block.indices[i])
+              continue;
+            // blocks from the one of k, included, to the one holding k,
+            // excluded
+            auto from = pmh_reduce<B>(static_cast<std::size_t>(hashes[k]));
+            bool through = false;
+            for (; !through && blocks[from].overflow; from = from + 1 == B ? 0 : from + 1) {
+              through = from == b;
+              bool holds = false;
+              for (std::size_t e = 0; e < blocks[from].size && !holds; ++e)
+                holds = blocks[from].indices[e] == k;
+              if (holds)
+                break;
+            }
+            if (through)
+              placed = pmh_block_fingerprint(hashes[k], static_cast<uint8_t>(s)) != fingerprint;
+          }
+          block.fingerprints[i] = fingerprint;
+        }
+        block.seed = static_cast<uint8_t>(s);
+      }
+      placed_all = placed;
+    }
+    if (placed_all)
+      return {seed, blocks, hash};
+  }
+  pmh_block_phase_exceeded_budget();
+  return {0, {}, hash};
+}
+
+} // namespace bits
+
+// Cache line layout: keys are hashed once into 64 byte blocks holding one
+// byte fingerprints and item indices. A lookup reads one block, and compares
+// the key only when its fingerprint matches. Items keep their original order.
+template <class Budget = pmh_default_budget>
+struct basic_block_pmh {
+  template <std::size_t N, class Hash>
+  using tables_type = bits::pmh_block_tables<N, Hash>;
+
+  template <class Item, std::size_t N, class Hash, class Key, class PRG>
+  static constexpr bits::pmh_build<bits::carray<Item, N>, tables_type<N, Hash>>
+  make(bits::carray<Item, N> const &items, Hash const &hash, Key const &key, PRG prg) {
+    return {items, bits::make_pmh_block_tables<Budget>(items, hash, key, prg)};
+  }
+};
+
+using block_pmh = basic_block_pmh<>;
+
+} // namespace frozen
+
+#endif
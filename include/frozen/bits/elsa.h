@@ -23,15 +23,66 @@
 #ifndef FROZEN_LETITGO_ELSA_H
 #define FROZEN_LETITGO_ELSA_H
 
+#include <array>
+#include <cstdint>
+#include <tuple>
 #include <type_traits>
+#include <utility>
 
 namespace frozen {
 
-template <class T> struct elsa {
-  static_assert(std::is_integral<T>::value || std::is_enum<T>::value,
-                "only supports integral types, specialize for other types");
+namespace bits {
 
-  constexpr std::size_t operator()(T const &value, std::size_t seed) const {
+#if defined(__SIZEOF_INT128__)
+__extension__ typedef unsigned __int128 uint128_t;
+#endif
+
+// Xor of the high and low halves of the 128 bit product of a and b
+constexpr uint64_t multiply_fold(uint64_t a, uint64_t b) {
+#if defined(__SIZEOF_INT128__)
+  auto const product = static_cast<uint128_t>(a) * b;
+  return static_cast<uint64_t>(product) ^ static_cast<uint64_t>(product >> 64);
+#else
+  uint64_t const a_lo = a & 0xffffffff, a_hi = a >> 32;
+  uint64_t const b_lo = b & 0xffffffff, b_hi = b >> 32;
+  uint64_t const lo_lo = a_lo * b_lo, hi_lo = a_hi * b_lo;
+  uint64_t const lo_hi = a_lo * b_hi, hi_hi = a_hi * b_hi;
+  uint64_t const cross = (lo_lo >> 32) + (hi_lo & 0xffffffff) + lo_hi;
+  uint64_t const high = hi_hi + (hi_lo >> 32) + (cross >> 32);
+  uint64_t const low = (cross << 32) | (lo_lo & 0xffffffff);
+  return high ^ low;
+#endif
+}
+
+} // namespace bits
+
+// Integer mixers, the second parameter of elsa. They turn an integer and a
+// seed into a hash.
+
+// One 64x64->128 bit multiplication, whose halves are folded together
+struct multiply_fold_mixer {
+  constexpr std::size_t operator()(uint64_t value, std::size_t seed) const {
+    return static_cast<std::size_t>(
+        bits::multiply_fold(value ^ static_cast<uint64_t>(seed), 0x9e3779b97f4a7c15ULL));
+  }
+};
+
+// The finalizer of MurmurHash3, two multiplications and three shifts
+struct fmix_mixer {
+  constexpr std::size_t operator()(uint64_t value, std::size_t seed) const {
+    uint64_t key = value ^ static_cast<uint64_t>(seed);
+    key ^= key >> 33;
+    key *= 0xff51afd7ed558ccdULL;
+    key ^= key >> 33;
+    key *= 0xc4ceb9fe1a85ec53ULL;
+    key ^= key >> 33;
+    return static_cast<std::size_t>(key);
+  }
+};
+
+// Thomas Wang's shift and add chain, the historical mixer of elsa
+struct wang_mixer {
+  constexpr std::size_t operator()(uint64_t value, std::size_t seed) const {
     std::size_t key = seed ^ static_cast<std::size_t>(value);
     key = (~key) + (key << 21); // key = (key << 21) - key - 1;
     key = key ^ (key >> 24);
@@ -44,6 +95,128 @@ template <class T> struct elsa {
   }
 };
 
+template <class T, class Mixer = multiply_fold_mixer> struct elsa {
+  static_assert(std::is_integral<T>::value || std::is_enum<T>::value,
+                "only supports integral types, specialize for other types");
+
+  constexpr std::size_t operator()(T const &value, std::size_t seed) const {
+    return Mixer{}(static_cast<uint64_t>(value), seed);
+  }
+};
+
+namespace bits {
+
+// Hashes a sequence of words, two at a time: each pair goes through a single
+// multiply_fold, as in wyhash. The state, and thus the seed, is mixed into both
+// multiplicands: no single word zeroes the product for every seed.
+class word_hasher {
+  uint64_t h_;
+  uint64_t pending_ = 0;
+  bool has_pending_ = false;
+
+public:
+  constexpr explicit word_hasher(uint64_t seed) : h_(seed ^ 0x8ebc6af09c88c6e3ULL) {}
+
+  constexpr void add(uint64_t word) {
+    if (has_pending_)
+      h_ = multiply_fold(pending_ ^ h_ ^ 0xa0761d6478bd642fULL, word ^ h_ ^ 0xe7037ed1a0b428dbULL);
+    else
+      pending_ = word;
+    has_pending_ = !has_pending_;
+  }
+
+  constexpr uint64_t digest() const {
+    return has_pending_ ? multiply_fold(pending_ ^ h_ ^ 0xa0761d6478bd642fULL, h_ ^ 0xe7037ed1a0b428dbULL)
+                        : h_;
+  }
+};
+
+// Adds the words of a field to a word_hasher: integers as they are, small
+// integers of arrays packed by eight bytes, pairs, tuples and arrays field by
+// field, and anything else through its elsa hash
+template <class T>
+constexpr void hash_field(word_hasher &hasher, T const &value, std::size_t seed, long) {
+  hasher.add(elsa<T>{}(value, seed));
+}
+
+template <class T, class = std::enable_if_t<std::is_integral<T>::value || std::is_enum<T>::value>>
+constexpr void hash_field(word_hasher &hasher, T const &value, std::size_t, int) {
+  hasher.add(static_cast<uint64_t>(value));
+}
+
+template <class A, class B>
+constexpr void hash_field(word_hasher &hasher, std::pair<A, B> const &value, std::size_t seed, int) {
+  hash_field(hasher, value.first, seed, 0);
+  hash_field(hasher, value.second, seed, 0);
+}
+
+template <class... Ts, std::size_t... I>
+constexpr void hash_fields(word_hasher &hasher, std::tuple<Ts...> const &value, std::size_t seed,
+                           std::index_sequence<I...>) {
+  int unused[] = {0, (hash_field(hasher, std::get<I>(value), seed, 0), 0)...};
+  (void)unused;
+}
+
+template <class... Ts>
+constexpr void hash_field(word_hasher &hasher, std::tuple<Ts...> const &value, std::size_t seed, int) {
+  hash_fields(hasher, value, seed, std::make_index_sequence<sizeof...(Ts)>());
+}
+
+template <class T, std::size_t K>
+constexpr void hash_elements(word_hasher &hasher, std::array<T, K> const &value, std::size_t,
+                             std::true_type /* packed */) {
+  constexpr std::size_t per_word = sizeof(uint64_t) / sizeof(T);
+  for (std::size_t i = 0; i < K; i += per_word) {
+    uint64_t word = 0;
+    for (std::size_t j = 0; j < per_word && i + j < K; ++j)
+      word |= static_cast<uint64_t>(static_cast<std::make_unsigned_t<T>>(value[i + j])) << (8 * sizeof(T) * j);
+    hasher.add(word);
+  }
+}
+
+template <class T, std::size_t K>
+constexpr void hash_elements(word_hasher &hasher, std::array<T, K> const &value, std::size_t seed,
+                             std::false_type /* packed */) {
+  for (std::size_t i = 0; i < K; ++i)
+    hash_field(hasher, value[i], seed, 0);
+}
+
+template <class T, std::size_t K>
+constexpr void hash_field(word_hasher &hasher, std::array<T, K> const &value, std::size_t seed, int) {
+  hash_elements(hasher, value, seed,
+                std::integral_constant<bool, std::is_integral<T>::value && !std::is_same<T, bool>::value &&
+                                                 sizeof(T) < sizeof(uint64_t)>{});
+}
+
+template <class T>
+constexpr std::size_t hash_composite(T const &value, std::size_t seed) {
+  word_hasher hasher{static_cast<uint64_t>(seed)};
+  hash_field(hasher, value, seed, 0);
+  return static_cast<std::size_t>(hasher.digest());
+}
+
+} // namespace bits
+
+// Composite keys: all their fields are hashed in a single pass, see
+// bits::word_hasher. The Mixer of integral fields does not apply.
+template <class A, class B, class Mixer> struct elsa<std::pair<A, B>, Mixer> {
+  constexpr std::size_t operator()(std::pair<A, B> const &value, std::size_t seed) const {
+    return bits::hash_composite(value, seed);
+  }
+};
+
+template <class... Ts, class Mixer> struct elsa<std::tuple<Ts...>, Mixer> {
+  constexpr std::size_t operator()(std::tuple<Ts...> const &value, std::size_t seed) const {
+    return bits::hash_composite(value, seed);
+  }
+};
+
+template <class T, std::size_t K, class Mixer> struct elsa<std::array<T, K>, Mixer> {
+  constexpr std::size_t operator()(std::array<T, K> const &value, std::size_t seed) const {
+    return bits::hash_composite(value, seed);
+  }
+};
+
 template <class T> using anna = elsa<T>;
 } // namespace frozen
 
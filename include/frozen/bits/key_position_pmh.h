@@ -0,0 +1,177 @@
+/*
+ * Frozen
+ * Copyright 2016 QuarksLab
+ *
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+// gperf-like key positions: string keys are hashed on a few of their bytes,
+// chosen at construction so that they tell the keys apart, and on their
+// length.
+#ifndef FROZEN_LETITGO_KEY_POSITION_PMH_H
+#define FROZEN_LETITGO_KEY_POSITION_PMH_H
+
+#include "frozen/bits/algorithms.h"
+#include "frozen/bits/basic_types.h"
+#include "frozen/bits/pmh.h"
+
+#include <cstdint>
+
+namespace frozen {
+
+namespace bits {
+
+// The byte of value at position, counted from the start when positive and
+// from the end otherwise, -1 being the last byte. Zero when out of bounds.
+template <class String>
+constexpr uint64_t key_position_byte(String const &value, int position) {
+  auto const size = static_cast<std::size_t>(value.size());
+  auto const offset = static_cast<std::size_t>(position < 0 ? -(position + 1) : position);
+  if (offset >= size)
+    return 0;
+  auto const byte = value[position < 0 ? size - 1 - offset : offset];
+  return static_cast<uint64_t>(static_cast<unsigned char>(byte));
+}
+
+// Hashes the length of a key and its bytes at the chosen positions, packed in
+// a single word. When no positions tell the keys apart, every byte is hashed
+// with Hash instead.
+template <class Hash>
+struct key_position_hash : Hash {
+  static constexpr std::size_t max_positions = 6;
+
+  carray<int, max_positions> positions;
+  std::size_t count = 0;
+  bool whole_key = false;
+
+  constexpr key_position_hash(Hash const &hash) : Hash(hash), positions{} {}
+
+  template <class String>
+  constexpr uint64_t signature(String const &value) const {
+    uint64_t word = static_cast<uint64_t>(value.size() & 0xffff) << 48;
+    for (std::size_t i = 0; i < count; ++i)
+      word |= key_position_byte(value, positions[i]) << (8 * i);
+    return word;
+  }
+
+  template <class String>
+  constexpr std::size_t operator()(String const &value, std::size_t seed) const {
+    if (whole_key)
+      return Hash::operator()(value, seed);
+    return static_cast<std::size_t>(mix64(signature(value) ^ (static_cast<uint64_t>(seed) * 0xc6a4a7935bd1e995ULL)));
+  }
+};
+
+template <std::size_t N>
+struct by_signature {
+  carray<uint64_t, N> const *signatures;
+  constexpr bool operator()(std::size_t i, std::size_t j) const {
+    return (*signatures)[i] < (*signatures)[j];
+  }
+};
+
+// Number of distinct signatures, order listing the keys by signature
+template <std::size_t N>
+constexpr std::size_t count_signatures(carray<uint64_t, N> const &signatures,
+                                       carray<std::size_t, N> const &order) {
+  std::size_t distinct = 0;
+  for (std::size_t i = 0; i < N; ++i)
+    distinct += i == 0 || signatures[order[i]] != signatures[order[i - 1]];
+  return distinct;
+}
+
+// Greedily picks the position that splits the groups of keys sharing a
+// signature the most, until every key has its own signature.
+template <class Item, std::size_t N, class Hash, class Key>
+constexpr key_position_hash<Hash> make_key_position_hash(carray<Item, N> const &items,
+                                                         Hash const &hash,
+                                                         Key const &key) {
+  key_position_hash<Hash> result{hash};
+
+  int max_size = 0;
+  carray<uint64_t, N> signatures;
+  carray<std::size_t, N> order;
+  for (std::size_t i = 0; i < N; ++i) {
+    auto const size = static_cast<int>(key(items[i]).size());
+    max_size = size > max_size ? size : max_size;
+    signatures[i] = result.signature(key(items[i]));
+    order[i] = i;
+  }
+
+  carray<std::size_t, 256> seen;
+  std::size_t group = 0;
+  while (N > 1) {
+    order = sort(order, by_signature<N>{&signatures});
+    std::size_t const distinct = count_signatures(signatures, order);
+    if (distinct == N)
+      return result;
+    if (result.count == result.max_positions)
+      break;
+
+    // Number of distinct signatures once a byte is added, for each position
+    int best_position = 0;
+    std::size_t best_distinct = distinct;
+    for (int position = -max_size; position < max_size; ++position) {
+      std::size_t split = 0;
+      for (std::size_t i = 0; i < N; ++i) {
+        if (i == 0 || signatures[order[i]] != signatures[order[i - 1]])
+          ++group;
+        auto const byte = key_position_byte(key(items[order[i]]), position);
+        if (seen[byte] != group) {
+          seen[byte] = group;
+          ++split;
+        }
+      }
+      if (split > best_distinct) {
+        best_position = position;
+        best_distinct = split;
+      }
+    }
+    if (best_distinct == distinct)
+      break;
+
+    for (std::size_t i = 0; i < N; ++i)
+      signatures[i] |= key_position_byte(key(items[i]), best_position) << (8 * result.count);
+    result.positions[result.count++] = best_position;
+  }
+
+  result.whole_key = N > 1;
+  return result;
+}
+
+} // namespace bits
+
+// Hashes string keys on a few positions and their length, as gperf does,
+// which makes hashing long keys cheap. The positions are chosen at
+// construction, see make_key_position_hash, and Policy builds the perfect hash
+// on top of them. Keys that no six positions tell apart are hashed whole.
+template <class Policy = hanov_pmh>
+struct key_position_pmh {
+  template <std::size_t N, class Hash>
+  using tables_type = typename Policy::template tables_type<N, bits::key_position_hash<Hash>>;
+
+  template <class Item, std::size_t N, class Hash, class Key, class PRG>
+  static constexpr bits::pmh_build<bits::carray<Item, N>, tables_type<N, Hash>>
+  make(bits::carray<Item, N> const &items, Hash const &hash, Key const &key, PRG prg) {
+    return Policy::make(items, bits::make_key_position_hash(items, hash, key), key, prg);
+  }
+};
+
+} // namespace frozen
+
+#endif
@@ -0,0 +1,339 @@
+/*
+ * Frozen
+ * Copyright 2016 QuarksLab
+ *
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#ifndef FROZEN_LETITGO_BITS_LAYOUT_H
+#define FROZEN_LETITGO_BITS_LAYOUT_H
+
+#include "frozen/bits/algorithms.h"
+#include "frozen/bits/basic_types.h"
+#include "frozen/bits/learned.h"
+#include "frozen/bits/prefetch.h"
+#include "frozen/bits/soa.h"
+#include "frozen/bits/stree.h"
+
+#include <cstddef>
+#include <iterator>
+#include <type_traits>
+
+namespace frozen {
+
+namespace bits {
+
+// Rank in sorted order of every node of an Eytzinger tree of N nodes: the
+// tree is stored breadth first, and the children of node k are nodes 2k and
+// 2k + 1, counting from 1. Node k is stored at index k - 1.
+template <std::size_t N>
+constexpr carray<std::size_t, N> eytzinger_ranks() {
+  carray<std::size_t, N> ranks;
+  std::size_t k = 1;
+  while (2 * k <= N)
+    k *= 2;
+  for (std::size_t rank = 0; rank < N; ++rank) {
+    ranks[k - 1] = rank;
+    // in order successor: leftmost node of the right subtree, or first
+    // ancestor of which k is in the left subtree
+    if (2 * k + 1 <= N) {
+      k = 2 * k + 1;
+      while (2 * k <= N)
+        k *= 2;
+    } else {
+      while (k & 1)
+        k >>= 1;
+      k >>= 1;
+    }
+  }
+  return ranks;
+}
+
+// Iterates over the items of an Eytzinger tree of N nodes in sorted order.
+// It holds a node, 0 past the end, and moves to the next or previous one
+// through the tree; random access goes through the rank of every node and
+// the node of every rank.
+template <class Item, class Index, std::size_t N>
+class eytzinger_iterator {
+  Item const *items_;
+  Index const *ranks_;
+  Index const *nodes_;
+  std::size_t node_;
+
+  constexpr std::ptrdiff_t rank() const {
+    return node_ ? static_cast<std::ptrdiff_t>(ranks_[node_ - 1]) : static_cast<std::ptrdiff_t>(N);
+  }
+
+  constexpr void seek(std::ptrdiff_t rank) {
+    node_ = static_cast<std::size_t>(rank) < N ? nodes_[rank] + 1 : 0;
+  }
+
+public:
+  using iterator_category = std::random_access_iterator_tag;
+  using value_type = Item;
+  using difference_type = std::ptrdiff_t;
+  using pointer = Item const *;
+  using reference = Item const &;
+
+  constexpr eytzinger_iterator() : items_(nullptr), ranks_(nullptr), nodes_(nullptr), node_(0) {}
+  constexpr eytzinger_iterator(Item const *items, Index const *ranks, Index const *nodes, std::size_t node)
+      : items_(items), ranks_(ranks), nodes_(nodes), node_(node) {}
+
+  constexpr reference operator*() const { return items_[node_ - 1]; }
+  constexpr pointer operator->() const { return &items_[node_ - 1]; }
+  constexpr reference operator[](difference_type n) const { return *(*this + n); }
+
+  // in order successor: leftmost node of the right subtree, or parent of the
+  // first ancestor that is a left child
+  constexpr eytzinger_iterator &operator++() {
+    if (2 * node_ + 1 <= N) {
+      node_ = 2 * node_ + 1;
+      while (2 * node_ <= N)
+        node_ *= 2;
+    } else {
+      while (node_ & 1)
+        node_ >>= 1;
+      node_ >>= 1;
+    }
+    return *this;
+  }
+
+  // in order predecessor, the other way around; the last node comes before
+  // the end
+  constexpr eytzinger_iterator &operator--() {
+    if (node_ == 0) {
+      node_ = 1;
+      while (2 * node_ + 1 <= N)
+        node_ = 2 * node_ + 1;
+    } else if (2 * node_ <= N) {
+      node_ = 2 * node_;
+      while (2 * node_ + 1 <= N)
+        node_ = 2 * node_ + 1;
+    } else {
+      while (node_ && !(node_ & 1))
+        node_ >>= 1;
+      node_ >>= 1;
+    }
+    return *this;
+  }
+
+  constexpr eytzinger_iterator operator++(int) { auto self = *this; ++*this; return self; }
+  constexpr eytzinger_iterator operator--(int) { auto self = *this; --*this; return self; }
+  constexpr eytzinger_iterator &operator+=(difference_type n) { seek(rank() + n); return *this; }
+  constexpr eytzinger_iterator &operator-=(difference_type n) { seek(rank() - n); return *this; }
+
+  constexpr eytzinger_iterator operator+(difference_type n) const { auto self = *this; return self += n; }
+  constexpr eytzinger_iterator operator-(difference_type n) const { auto self = *this; return self -= n; }
+  friend constexpr eytzinger_iterator operator+(difference_type n, eytzinger_iterator const &it) { return it + n; }
+  constexpr difference_type operator-(eytzinger_iterator const &other) const { return rank() - other.rank(); }
+
+  constexpr bool operator==(eytzinger_iterator const &other) const { return node_ == other.node_; }
+  constexpr bool operator!=(eytzinger_iterator const &other) const { return node_ != other.node_; }
+  constexpr bool operator<(eytzinger_iterator const &other) const { return rank() < other.rank(); }
+  constexpr bool operator<=(eytzinger_iterator const &other) const { return rank() <= other.rank(); }
+  constexpr bool operator>(eytzinger_iterator const &other) const { return rank() > other.rank(); }
+  constexpr bool operator>=(eytzinger_iterator const &other) const { return rank() >= other.rank(); }
+};
+
+// Sorted items stored as an Eytzinger tree. A search reads nodes 1, 2 or 3,
+// 4 to 7, and so on: the nodes visited first share a few cache lines, and the
+// four grandchildren of a node are contiguous, so they are prefetched while
+// the node is compared. Iterators still visit the items in sorted order.
+template <class Item, std::size_t N>
+class eytzinger_array {
+  using index_type = select_uint_least_t<log(N) + 1>;
+
+  carray<Item, N> items_;
+  carray<index_type, N> ranks_; // node - 1 -> rank
+  carray<index_type, N> nodes_; // rank -> node - 1
+
+  static constexpr carray<index_type, N> invert(carray<std::size_t, N> const &ranks) {
+    carray<index_type, N> nodes;
+    for (std::size_t i = 0; i < N; ++i)
+      nodes[ranks[i]] = static_cast<index_type>(i);
+    return nodes;
+  }
+
+  static constexpr carray<index_type, N> narrow(carray<std::size_t, N> const &ranks) {
+    carray<index_type, N> narrowed;
+    for (std::size_t i = 0; i < N; ++i)
+      narrowed[i] = static_cast<index_type>(ranks[i]);
+    return narrowed;
+  }
+
+  // Items that can be default constructed are moved in a loop, others
+  // through a pack expansion, which is slower to compile for large N
+  static constexpr carray<Item, N> arrange(carray<Item, N> const &sorted,
+                                           carray<std::size_t, N> const &ranks,
+                                           std::true_type /* default constructible */) {
+    carray<Item, N> items;
+    for (std::size_t i = 0; i < N; ++i)
+      cassign(items[i], sorted[ranks[i]]);
+    return items;
+  }
+
+  static constexpr carray<Item, N> arrange(carray<Item, N> const &sorted,
+                                           carray<std::size_t, N> const &ranks,
+                                           std::false_type /* default constructible */) {
+    return permute(sorted, ranks);
+  }
+
+  constexpr eytzinger_array(carray<Item, N> const &sorted, carray<std::size_t, N> const &ranks)
+      : items_(arrange(sorted, ranks, std::is_default_constructible<Item>{})),
+        ranks_(narrow(ranks)), nodes_(invert(ranks)) {}
+
+public:
+  using value_type = Item;
+  using size_type = std::size_t;
+  using difference_type = std::ptrdiff_t;
+  using const_reference = Item const &;
+  using const_pointer = Item const *;
+  using const_iterator = eytzinger_iterator<Item, index_type, N>;
+  using const_reverse_iterator = std::reverse_iterator<const_iterator>;
+
+  // Takes the items in sorted order
+  constexpr eytzinger_array(carray<Item, N> const &sorted)
+      : eytzinger_array(sorted, eytzinger_ranks<N>()) {}
+
+  constexpr const_iterator begin() const { return at_node(nodes_[0] + 1); }
+  constexpr const_iterator end() const { return at_node(0); }
+  constexpr const_iterator cbegin() const { return begin(); }
+  constexpr const_iterator cend() const { return end(); }
+  constexpr const_reverse_iterator rbegin() const { return const_reverse_iterator(end()); }
+  constexpr const_reverse_iterator rend() const { return const_reverse_iterator(begin()); }
+  constexpr const_reverse_iterator crbegin() const { return rbegin(); }
+  constexpr const_reverse_iterator crend() const { return rend(); }
+
+  // First item not lower than value, or end(). The descent is branchless:
+  // it goes right past the items lower than value, and the answer is the
+  // last node where it went left.
+  template <class T, class Compare>
+  constexpr const_iterator lower_bound(T const &value, Compare const &compare) const {
+    std::size_t k = 1;
+    while (k <= N) {
+      if (4 * k <= N)
+        FROZEN_CONSTEXPR_PREFETCH(&items_[4 * k - 1]);
+      k = 2 * k + compare(items_[k - 1], value);
+    }
+    // drop the right turns taken since the last left turn, then that one
+#if defined(__GNUC__) || defined(__clang__)
+    k >>= __builtin_ctzll(~static_cast<unsigned long long>(k)) + 1;
+#else
+    while (k & 1)
+      k >>= 1;
+    k >>= 1;
+#endif
+    return at_node(k);
+  }
+
+private:
+  constexpr const_iterator at_node(std::size_t node) const {
+    return {items_.begin(), ranks_.begin(), nodes_.begin(), node};
+  }
+};
+
+// Lower bound of value in the items of a sorted container: a binary search
+// of sorted arrays, or the search of other layouts
+template <class Item, std::size_t N, class T, class Compare>
+constexpr typename carray<Item, N>::const_iterator
+layout_lower_bound(carray<Item, N> const &items, T const &value, Compare const &compare) {
+  return lower_bound<N>(items.begin(), value, compare);
+}
+
+template <class Storage, class T, class Compare>
+constexpr typename Storage::const_iterator
+layout_lower_bound(Storage const &items, T const &value, Compare const &compare) {
+  return items.lower_bound(value, compare);
+}
+
+// Batched lower bounds, see lower_bound_many. Other layouts search a key at
+// a time, their searches being shallow enough.
+template <class Item, std::size_t N, class ForwardIt, class Compare, class F>
+void layout_lower_bound_many(carray<Item, N> const &items, ForwardIt first, ForwardIt last,
+                             Compare const &compare, F &&f) {
+  lower_bound_many<N>(items.begin(), first, last, compare, f);
+}
+
+template <class Storage, class ForwardIt, class Compare, class F>
+void layout_lower_bound_many(Storage const &items, ForwardIt first, ForwardIt last,
+                             Compare const &compare, F &&f) {
+  for (; first != last; ++first)
+    f(*first, items.lower_bound(*first, compare));
+}
+
+template <class Key, class Value, std::size_t N, class ForwardIt, class Compare, class F>
+void layout_lower_bound_many(soa_array<Key, Value, N> const &items, ForwardIt first, ForwardIt last,
+                             Compare const &compare, F &&f) {
+  auto const keys = items.keys().begin();
+  lower_bound_many<N>(keys, first, last, compare, [&](auto const &key, Key const *where) {
+    f(key, items.begin() + (where - keys));
+  });
+}
+
+} // namespace bits
+
+// Layouts select how sorted containers store their items. A layout provides
+// a storage_type<Key, Item, N>, built from the items in sorted order, and
+// iterated over in that order. Items are keys for sets, and pairs of a key and
+// a value for maps. frozen::unordered_map takes array_layout or soa_layout,
+// and stores its items in the order of their slots.
+
+// Sorted array, searched with a binary search. The default.
+struct sorted_layout {
+  template <class Key, class Item, std::size_t N>
+  using storage_type = bits::carray<Item, N>;
+};
+
+// Array of items, whatever their order
+using array_layout = sorted_layout;
+
+// Eytzinger tree, searched from the root down, see bits::eytzinger_array.
+// Faster than the binary search once the items no longer fit in the cache,
+// at the cost of two indices per item.
+struct eytzinger_layout {
+  template <class Key, class Item, std::size_t N>
+  using storage_type = bits::eytzinger_array<Item, N>;
+};
+
+// Static B-tree of 16 keys per node, see bits::stree_array. The fewest cache
+// misses per search, and SIMD node searches for integer keys; costs up to 15
+// padding slots, two indices per item, and a copy of the keys of maps.
+struct stree_layout {
+  template <class Key, class Item, std::size_t N>
+  using storage_type = bits::stree_array<Key, Item, N>;
+};
+
+// Keys and values of maps in two arrays, see bits::soa_array: searches read
+// keys only, which pays off on large values. Iterators yield pairs of
+// references. Sets store their keys as sorted_layout does.
+struct soa_layout {
+  template <class Key, class Item, std::size_t N>
+  using storage_type = typename bits::soa_storage<Key, Item, N>::type;
+};
+
+// Sorted array of integer or enum keys, and a linear model of their
+// distribution, see bits::learned_array. Fewer probes than the binary search
+// when keys are spread evenly, at the cost of less than a byte per item.
+struct learned_layout {
+  template <class Key, class Item, std::size_t N>
+  using storage_type = bits::learned_array<Key, Item, N>;
+};
+
+} // namespace frozen
+
+#endif
@@ -0,0 +1,220 @@
+/*
+ * Frozen
+ * Copyright 2016 QuarksLab
+ *
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#ifndef FROZEN_LETITGO_BITS_LEARNED_H
+#define FROZEN_LETITGO_BITS_LEARNED_H
+
+#include "frozen/bits/algorithms.h"
+#include "frozen/bits/basic_types.h"
+#include "frozen/bits/stree.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <type_traits>
+
+namespace frozen {
+
+namespace bits {
+
+// Items per leaf model of a learned_array, on average
+constexpr std::size_t learned_model_size = 32;
+
+// Position predicted by a line, as intercept + slope * x, clamped to
+// [0, size]. Rounding keeps it non-decreasing in x.
+struct learned_line {
+  double intercept = 0;
+  double slope = 0;
+
+  constexpr std::size_t operator()(double x, std::size_t size) const {
+    double const y = intercept + slope * x;
+    return y <= 0 ? 0 : y >= static_cast<double>(size) ? size : static_cast<std::size_t>(y);
+  }
+};
+
+// Least squares fit of scale * rank to xs[rank], for ranks in [first, last),
+// with a non-negative slope
+constexpr learned_line learned_fit(double const *xs, std::size_t first, std::size_t last, double scale) {
+  learned_line line;
+  if (first == last)
+    return line;
+  double const n = static_cast<double>(last - first);
+  double mean_x = 0, mean_y = 0;
+  for (std::size_t i = first; i < last; ++i) {
+    mean_x += xs[i];
+    mean_y += scale * static_cast<double>(i);
+  }
+  mean_x /= n;
+  mean_y /= n;
+  double covariance = 0, variance = 0;
+  for (std::size_t i = first; i < last; ++i) {
+    double const dx = xs[i] - mean_x;
+    covariance += dx * (scale * static_cast<double>(i) - mean_y);
+    variance += dx * dx;
+  }
+  line.slope = variance > 0 && covariance > 0 ? covariance / variance : 0;
+  line.intercept = mean_y - line.slope * mean_x;
+  return line;
+}
+
+// Sorted items of integer or enum keys, and a two level model of their
+// distribution, in the manner of a recursive model index: a root line sends
+// a key to one of Models leaf lines, and the leaf line predicts its position,
+// within the errors it made on the items it was trained on. The search ends
+// with a bisection of that window. Both levels are non-decreasing in the key,
+// so that keys not in the array find their lower bound in the window too.
+template <class Key, class Item, std::size_t N>
+class learned_array {
+  static_assert(std::is_integral<Key>::value || std::is_enum<Key>::value,
+                "learned_layout only supports integral and enum keys");
+
+  static constexpr std::size_t Models = N / learned_model_size ? N / learned_model_size : 1;
+  using index_type = select_uint_least_t<log(N) + 1>;
+
+  carray<Item, N> items_;
+  uint64_t min_;
+  learned_line root_;
+  carray<learned_line, Models> leaves_;
+  carray<index_type, Models + 1> firsts_; // first item of every leaf
+  carray<index_type, Models> below_;      // largest overestimate of a leaf
+  carray<index_type, Models> above_;      // largest underestimate of a leaf
+
+  struct model {
+    learned_line root;
+    carray<learned_line, Models> leaves;
+    carray<index_type, Models + 1> firsts;
+    carray<index_type, Models> below;
+    carray<index_type, Models> above;
+  };
+
+  static constexpr model train(carray<Item, N> const &items) {
+    carray<double, N> xs;
+    for (std::size_t i = 0; i < N; ++i)
+      xs[i] = static_cast<double>(dense_ordinal(item_key{}(items[i])) - dense_ordinal(item_key{}(items[0])));
+
+    model m;
+    m.root = learned_fit(xs.begin(), 0, N, static_cast<double>(Models) / static_cast<double>(N));
+    std::size_t leaf = 0;
+    m.firsts[0] = 0;
+    for (std::size_t i = 0; i < N; ++i)
+      for (auto const target = m.root(xs[i], Models - 1); leaf < target;)
+        m.firsts[++leaf] = static_cast<index_type>(i);
+    while (leaf < Models)
+      m.firsts[++leaf] = static_cast<index_type>(N);
+
+    for (std::size_t j = 0; j < Models; ++j) {
+      m.leaves[j] = learned_fit(xs.begin(), m.firsts[j], m.firsts[j + 1], 1);
+      std::size_t below = 0, above = 0;
+      for (std::size_t i = m.firsts[j]; i < m.firsts[j + 1]; ++i) {
+        auto const predicted = m.leaves[j](xs[i], N);
+        below = predicted > i && predicted - i > below ? predicted - i : below;
+        above = predicted < i && i - predicted > above ? i - predicted : above;
+      }
+      // one more on both sides, for rounding that differs at runtime
+      m.below[j] = static_cast<index_type>(below + 1);
+      m.above[j] = static_cast<index_type>(above + 1);
+    }
+    return m;
+  }
+
+  constexpr learned_array(carray<Item, N> const &sorted, model const &m)
+      : items_(sorted), min_(dense_ordinal(item_key{}(sorted[0]))), root_(m.root), leaves_(m.leaves),
+        firsts_(m.firsts), below_(m.below), above_(m.above) {}
+
+public:
+  using value_type = Item;
+  using size_type = std::size_t;
+  using difference_type = std::ptrdiff_t;
+  using const_reference = Item const &;
+  using const_pointer = Item const *;
+  using const_iterator = typename carray<Item, N>::const_iterator;
+  using const_reverse_iterator = typename carray<Item, N>::const_reverse_iterator;
+
+  // Takes the items in sorted order
+  constexpr learned_array(carray<Item, N> const &sorted)
+      : learned_array(sorted, train(sorted)) {}
+
+  constexpr const_iterator begin() const { return items_.begin(); }
+  constexpr const_iterator end() const { return items_.end(); }
+  constexpr const_iterator cbegin() const { return items_.cbegin(); }
+  constexpr const_iterator cend() const { return items_.cend(); }
+  constexpr const_reverse_iterator rbegin() const { return items_.rbegin(); }
+  constexpr const_reverse_iterator rend() const { return items_.rend(); }
+  constexpr const_reverse_iterator crbegin() const { return items_.crbegin(); }
+  constexpr const_reverse_iterator crend() const { return items_.crend(); }
+
+  // First item not lower than value, or end(). Keys ordered otherwise than
+  // by operator<, or of another type, are found by a binary search.
+  template <class T, class Compare>
+  constexpr const_iterator lower_bound(T const &value, Compare const &compare) const {
+    return lower_bound(value, compare,
+                       std::integral_constant<bool, std::is_same<T, Key>::value &&
+                                                        is_natural_order<Compare, Key>::value>{});
+  }
+
+private:
+  template <class T, class Compare>
+  constexpr const_iterator lower_bound(T const &value, Compare const &compare,
+                                       std::false_type /* modeled */) const {
+    return bits::lower_bound<N>(items_.begin(), value, compare);
+  }
+
+  template <class T, class Compare>
+  constexpr const_iterator lower_bound(T const &value, Compare const &compare,
+                                       std::true_type /* modeled */) const {
+    auto const ordinal = dense_ordinal(value);
+    if (ordinal < min_)
+      return begin();
+    double const x = static_cast<double>(ordinal - min_);
+    auto const leaf = root_(x, Models - 1);
+    auto const predicted = leaves_[leaf](x, N);
+    std::size_t const first = firsts_[leaf], last = firsts_[leaf + 1];
+
+    // window within the leaf, empty for leaves without items
+    std::size_t low = predicted > below_[leaf] ? predicted - below_[leaf] : 0;
+    std::size_t high = predicted + above_[leaf] + 1;
+    low = low < first ? first : low > last ? last : low;
+    high = high < low ? low : high > last ? last : high;
+
+    // branchless bisection of [low, high], see lower_bound_many
+    auto where = items_.begin() + low;
+    std::size_t len = high - low;
+    while (len > 1) {
+      auto const half = len / 2;
+      where += compare(where[half - 1], value) ? half : 0;
+      len -= half;
+    }
+    where += len && compare(*where, value);
+
+    // The model is trained in constant evaluation, and the rounding of the
+    // floating point may differ at runtime, e.g. through fused multiply-adds:
+    // a window that misses the lower bound falls back to a binary search.
+    if ((where != begin() && !compare(*(where - 1), value)) || (where != end() && compare(*where, value)))
+      return bits::lower_bound<N>(items_.begin(), value, compare);
+    return where;
+  }
+};
+
+} // namespace bits
+
+} // namespace frozen
+
+#endif
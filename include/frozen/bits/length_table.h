@@ -0,0 +1,131 @@
+/*
+ * Frozen
+ * Copyright 2016 QuarksLab
+ *
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+// Keys of a string dictionary grouped by length: a lookup first reads the
+// range of keys of the same length as the queried one.
+#ifndef FROZEN_LETITGO_LENGTH_TABLE_H
+#define FROZEN_LETITGO_LENGTH_TABLE_H
+
+#include "frozen/bits/algorithms.h"
+#include "frozen/bits/basic_types.h"
+#include "frozen/bits/pmh.h"
+#include "frozen/string.h"
+
+namespace frozen {
+
+namespace bits {
+
+// Keys of 0 to 63 bytes have a class of their own, longer keys share the last
+// one
+constexpr std::size_t length_classes = 65;
+
+constexpr std::size_t length_class(std::size_t size) {
+  return size < length_classes - 1 ? size : length_classes - 1;
+}
+
+// Classes of up to this many keys are scanned, larger ones go through the
+// perfect hash function
+constexpr std::size_t length_scan_limit = 4;
+
+struct length_range {
+  std::size_t first;
+  std::size_t count;
+};
+
+constexpr bool length_equal(string a, string b) {
+  return a.size() == b.size() && equal_bytes(a.data(), b.data(), a.size());
+}
+
+// Items sorted by key length, the range of each length class in items, and a
+// perfect hash function over the keys of the classes that are not scanned
+// only; without such classes, it is not built. Its tables are sized for N keys
+// nonetheless, as the type cannot depend on the lengths of the keys.
+template <class Item, std::size_t N, class Hash>
+struct length_table {
+  using tables_type = typename hanov_pmh::template tables_type<N, Hash>;
+
+  carray<Item, N> items;
+  carray<length_range, length_classes> ranges;
+  tables_type tables;
+
+  // Index of key in items, or N
+  template <class Key>
+  constexpr std::size_t lookup(string const &value, Key const &key) const {
+    auto const &range = ranges[length_class(value.size())];
+    if (range.count <= length_scan_limit) {
+      for (std::size_t i = range.first; i < range.first + range.count; ++i)
+        if (length_equal(key(items[i]), value))
+          return i;
+      return N;
+    }
+    auto const index = tables.lookup(value);
+    if (index != N && length_equal(key(items[index]), value))
+      return index;
+    return N;
+  }
+};
+
+template <class Item, std::size_t N, class Hash, class Key, class PRG>
+constexpr length_table<Item, N, Hash> make_length_table(carray<Item, N> const &items,
+                                                        Hash const &hash,
+                                                        Key const &key, PRG prg) {
+  using tables_type = typename length_table<Item, N, Hash>::tables_type;
+  using index_type = typename tables_type::index_type;
+
+  // Counting sort of the items by length class
+  carray<length_range, length_classes> ranges;
+  for (std::size_t i = 0; i < N; ++i)
+    ++ranges[length_class(key(items[i]).size())].count;
+  carray<std::size_t, length_classes> next;
+  for (std::size_t c = 0, first = 0; c < length_classes; first += ranges[c++].count)
+    ranges[c].first = next[c] = first;
+  carray<std::size_t, N> order;
+  for (std::size_t i = 0; i < N; ++i)
+    order[next[length_class(key(items[i]).size())]++] = i;
+  auto const sorted = permute(items, order);
+
+  // Position in sorted of the keys of the classes that are not scanned
+  carray<std::size_t, N> positions;
+  std::size_t hashed = 0;
+  for (std::size_t i = 0; i < N; ++i)
+    if (ranges[length_class(key(sorted[i]).size())].count > length_scan_limit)
+      positions[hashed++] = i;
+  if (!hashed)
+    return {sorted, ranges, tables_type{0, {}, {}, hash}};
+
+  // The function is built over these keys only, then its indices are turned
+  // into indices in sorted
+  auto tables = make_pmh_tables<pmh_default_storage::size(N)>(permute(sorted, positions), hash, key,
+                                                              prg, hashed);
+  for (std::size_t i = 0; i < tables_type::storage_size; ++i) {
+    if (!tables.first_table_[i].is_seed())
+      tables.first_table_[i] = {false, positions[tables.first_table_[i].value()]};
+    tables.second_table_[i] = static_cast<index_type>(positions[tables.second_table_[i]]);
+  }
+  return {sorted, ranges, tables};
+}
+
+} // namespace bits
+
+} // namespace frozen
+
+#endif
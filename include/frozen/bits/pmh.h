@@ -26,87 +26,151 @@
 
 #include "frozen/bits/algorithms.h"
 #include "frozen/bits/basic_types.h"
+#include "frozen/bits/exceptions.h"
+#include "frozen/bits/prefetch.h"
 
 #include <array>
+#include <cstdint>
+#include <type_traits>
 
 namespace frozen {
 
+// Bounds the work done by pmh construction. Reseeds is the number of global
+// seeds tried by each phase, BucketAttempts the number of seeds tried to place
+// a single bucket before starting over with a new global seed.
+template <std::size_t Reseeds, std::size_t BucketAttempts>
+struct pmh_budget {
+  static_assert(Reseeds > 0 && BucketAttempts > 0, "pmh budget must allow one attempt");
+  static constexpr std::size_t reseeds = Reseeds;
+  static constexpr std::size_t bucket_attempts = BucketAttempts;
+};
+
+using pmh_default_budget = pmh_budget<16, 1024>;
+
 namespace bits {
 
-// Function object for sorting buckets in decreasing order of size
-struct bucket_size_compare {
-  template <typename B>
-  bool constexpr operator()(B const &b0,
-                            B const &b1) const {
-    return b0.size() > b1.size();
-  }
-};
+// Called when pmh construction runs out of attempts. These are not constexpr,
+// so reaching one of them during constant evaluation fails to compile with the
+// name of the phase that gave up. This usually means that some keys are equal,
+// or hash to the same value whatever the seed.
+inline void pmh_bucket_phase_exceeded_budget() {
+  FROZEN_THROW_OR_ABORT(std::runtime_error("pmh: no seed spreads the keys into buckets"));
+}
+
+inline void pmh_placement_phase_exceeded_budget() {
+  FROZEN_THROW_OR_ABORT(std::runtime_error("pmh: no seed places the keys in free slots"));
+}
+
+// Range reduction of a hash to [0, M): a mask for powers of two, and a
+// multiply-shift otherwise, which is cheaper than a modulo. The hash is first
+// scrambled by a multiplication, as the multiply-shift only looks at its high
+// bits.
+template <std::size_t M>
+constexpr std::size_t pmh_reduce(std::size_t h) {
+  return (M & (M - 1)) == 0
+             ? h & (M - 1)
+             : fastrange(static_cast<uint64_t>(h) * 0x9e3779b97f4a7c15ULL, M);
+}
+
+// Keys are hashed once, with the first seed. The hash used to place a key of a
+// multi-item bucket is derived from this base hash and the seed of the bucket,
+// which is much cheaper than hashing the key again. Keys with the same base
+// hash cannot be told apart this way, which makes the builder pick another
+// first seed.
+constexpr std::size_t pmh_remix(uint64_t base, uint64_t seed) {
+  return static_cast<std::size_t>(mix64(base ^ (seed * 0xc6a4a7935bd1e995ULL)));
+}
 
 // Step One in pmh routine is to take all items and hash them into buckets,
 // with some collisions. Then process those buckets further to build a perfect
 // hash function.
-// pmh_buckets represents the initial placement into buckets.
+// pmh_buckets represents the initial placement into buckets, as compressed
+// rows: the items of bucket b are items[starts[b]] to items[starts[b + 1] - 1],
+// in increasing order, and order lists the buckets by decreasing size. This
+// takes O(M + N) memory during constant evaluation.
 
-template <size_t M>
+template <size_t M, size_t N>
 struct pmh_buckets {
   // Step 0: Bucket max is 2 * sqrt M
   // TODO: Come up with justification for this, should it not be O(log M)?
-  static constexpr auto bucket_max = 2 * (1u << (log(M) / 2));
+  static constexpr std::size_t bucket_max = 2 * (1u << (log(M) / 2));
 
-  using bucket_t = cvector<std::size_t, bucket_max>;
-  carray<bucket_t, M> buckets;
   uint64_t seed;
+  carray<std::size_t, M + 1> starts;
+  carray<std::size_t, N> items;
+  carray<std::size_t, M> order;
 
-  // Represents a reference to a bucket. This is used because the buckets
-  // have to be sorted, but buckets are big, making it slower than sorting refs
+  // A bucket: its index, which is the reduced hash of its items, and the
+  // indices of its items
   struct bucket_ref {
-    unsigned hash;
-    const bucket_t * ptr;
+    std::size_t hash;
+    std::size_t const *first;
+    std::size_t count;
 
-    // Forward some interface of bucket
-    using value_type = typename bucket_t::value_type;
-    using const_iterator = typename bucket_t::const_iterator;
-
-    constexpr auto size() const { return ptr->size(); }
-    constexpr const auto & operator[](std::size_t idx) const { return (*ptr)[idx]; }
-    constexpr auto begin() const { return ptr->begin(); }
-    constexpr auto end() const { return ptr->end(); }
+    constexpr std::size_t size() const { return count; }
+    constexpr std::size_t operator[](std::size_t idx) const { return first[idx]; }
   };
 
-  // Make a bucket_ref for each bucket
-  template <std::size_t... Is>
-  carray<bucket_ref, M> constexpr make_bucket_refs(std::index_sequence<Is...>) const {
-    return {{ bucket_ref{Is, &buckets[Is]}... }};
-  }
-
-  // Makes a bucket_ref for each bucket and sorts them by size
-  carray<bucket_ref, M> constexpr get_sorted_buckets() const {
-    carray<bucket_ref, M> result{this->make_bucket_refs(std::make_index_sequence<M>())};
-    bits::quicksort(result.begin(), result.end() - 1, bucket_size_compare{});
-    return result;
+  // The bucket of the given rank, by decreasing size
+  constexpr bucket_ref bucket(std::size_t rank) const {
+    auto const b = order[rank];
+    return {b, items.begin() + starts[b], starts[b + 1] - starts[b]};
   }
 };
 
+// Only the first count items are placed, the others are left out of the
+// function.
 template <size_t M, class Item, size_t N, class Hash, class Key, class PRG>
-pmh_buckets<M> constexpr make_pmh_buckets(const carray<Item, N> & items,
+pmh_buckets<M, N> constexpr make_pmh_buckets(const carray<Item, N> & items,
                                 Hash const & hash,
                                 Key const & key,
-                                PRG & prg) {
-  using result_t = pmh_buckets<M>;
+                                carray<uint64_t, N> & hashes,
+                                PRG & prg,
+                                std::size_t max_attempts,
+                                std::size_t count = N) {
+  using result_t = pmh_buckets<M, N>;
   result_t result{};
   // Continue until all items are placed without exceeding bucket_max
-  while (1) {
-    for (auto & b : result.buckets) {
-      b.clear();
-    }
+  for (std::size_t attempt = 0; attempt < max_attempts; ++attempt) {
     result.seed = prg();
-    for (std::size_t i = 0; i < N; ++i) {
-      auto & bucket = result.buckets[hash(key(items[i]), static_cast<size_t>(result.seed)) % M];
-      if (bucket.size() >= result_t::bucket_max) { continue; }
-      bucket.push_back(i);
+
+    // Count the items of bucket b in starts[b + 1]
+    result.starts.fill(0);
+    bool overflow = false;
+    for (std::size_t i = 0; i < count && !overflow; ++i) {
+      hashes[i] = static_cast<uint64_t>(hash(key(items[i]), static_cast<size_t>(result.seed)));
+      auto & size = result.starts[pmh_reduce<M>(hashes[i]) + 1];
+      if (size >= result_t::bucket_max) { overflow = true; }
+      else { ++size; }
     }
+    if (overflow)
+      continue;
+
+    // Counting sort of the buckets on their size, largest first
+    carray<std::size_t, result_t::bucket_max + 1> sizes;
+    for (std::size_t b = 0; b < M; ++b)
+      ++sizes[result.starts[b + 1]];
+    std::size_t rank = 0;
+    for (std::size_t size = result_t::bucket_max + 1; size-- > 0;) {
+      auto const buckets = sizes[size];
+      sizes[size] = rank;
+      rank += buckets;
+    }
+    for (std::size_t b = 0; b < M; ++b)
+      result.order[sizes[result.starts[b + 1]]++] = b;
+
+    // Offsets of the buckets, then their items
+    for (std::size_t b = 0; b < M; ++b)
+      result.starts[b + 1] += result.starts[b];
+    carray<std::size_t, M> next;
+    for (std::size_t b = 0; b < M; ++b)
+      next[b] = result.starts[b];
+    for (std::size_t i = 0; i < count; ++i)
+      result.items[next[pmh_reduce<M>(hashes[i])]++] = i;
     return result;
   }
+  pmh_bucket_phase_exceeded_budget();
+  return result;
 }
 
 // Check if an item appears in a cvector
@@ -121,12 +185,15 @@ constexpr bool all_different_from(cvector<T, N> & data, T & a) {
 
 // Represents either an index to a data item array, or a seed to be used with
 // a hasher. Seed must have high bit of 1, value has high bit of zero.
+// The underlying integer is the narrowest one able to hold an index, so that
+// small tables stay small; seeds are truncated to fit in the remaining bits.
+template <class UInt>
 struct seed_or_index {
-  using value_type = uint64_t;
+  using value_type = UInt;
 
 private:
-  static constexpr value_type MINUS_ONE = -1;
-  static constexpr value_type HIGH_BIT = ~(MINUS_ONE >> 1);
+  static constexpr value_type MINUS_ONE = static_cast<value_type>(-1);
+  static constexpr value_type HIGH_BIT = static_cast<value_type>(~(MINUS_ONE >> 1));
 
   value_type value_ = 0;
 
@@ -134,101 +201,495 @@ public:
   constexpr value_type value() const { return value_; }
   constexpr bool is_seed() const { return value_ & HIGH_BIT; }
 
-  constexpr seed_or_index(bool is_seed, value_type value)
-    : value_(is_seed ? (value | HIGH_BIT) : (value & ~HIGH_BIT)) {}
+  constexpr seed_or_index(bool is_seed, uint64_t value)
+    : value_(static_cast<value_type>(is_seed ? (value | HIGH_BIT) : (value & ~HIGH_BIT))) {}
 
   constexpr seed_or_index() = default;
-  constexpr seed_or_index(const seed_or_index &) = default;
-  constexpr seed_or_index & operator =(const seed_or_index &) = default;
+};
+
+// Integer types used to store the pmh tables for N items in M slots.
+// An index only needs enough bits to address N items; an entry of the first
+// table needs one more bit to tell seeds from indices, and at least 16 bits
+// overall so that enough distinct seeds can be tried when placing buckets.
+template <std::size_t M, std::size_t N>
+struct pmh_table_types {
+  static constexpr std::size_t index_bits = log(N) + 1;
+  static constexpr std::size_t seed_bits = index_bits + 1 < 16 ? 16 : index_bits + 1;
+
+  using index_type = select_uint_least_t<index_bits>;
+  using seed_or_index_type = seed_or_index<select_uint_least_t<seed_bits>>;
 };
 
 // Represents the perfect hash function created by pmh algorithm
-template <std::size_t M, class Hasher>
+template <std::size_t M, std::size_t N, class Hasher>
 struct pmh_tables {
+  using seed_or_index_type = typename pmh_table_types<M, N>::seed_or_index_type;
+  using index_type = typename pmh_table_types<M, N>::index_type;
+
+  static constexpr std::size_t storage_size = M;
+
   uint64_t first_seed_;
-  carray<seed_or_index, M> first_table_;
-  carray<std::size_t, M> second_table_;
+  carray<seed_or_index_type, M> first_table_;
+  carray<index_type, M> second_table_;
   Hasher hash_;
 
+  // Hashes a given key, once per lookup
+  template <typename KeyType>
+  constexpr uint64_t hash(const KeyType & key) const {
+    return static_cast<uint64_t>(hash_(key, static_cast<size_t>(first_seed_)));
+  }
+
+  // Prefetches the first table entry of a key with hash h
+  void prefetch(uint64_t h) const { FROZEN_PREFETCH(&first_table_[pmh_reduce<M>(h)]); }
+
+  // Finds the expected index in carray<Item, N> of a key with hash h
+  constexpr std::size_t lookup_hash(uint64_t h) const {
+    auto const d = first_table_[pmh_reduce<M>(h)];
+    if (!d.is_seed()) { return static_cast<std::size_t>(d.value()); }
+    else { return second_table_[pmh_reduce<M>(pmh_remix(h, d.value()))]; }
+  }
+
   // Looks up a given key, to find its expected index in carray<Item, N>
   // Always returns a valid index, must use KeyEqual test after to confirm.
   template <typename KeyType>
   constexpr std::size_t lookup(const KeyType & key) const {
-    auto const d = first_table_[hash_(key, static_cast<size_t>(first_seed_)) % M];
-    if (!d.is_seed()) { return static_cast<std::size_t>(d.value()); } // this is narrowing uint64 -> size_t but should be fine
-    else { return second_table_[hash_(key, static_cast<std::size_t>(d.value())) % M]; }
+    return lookup_hash(hash(key));
   }
 };
 
-// Make pmh tables for given items, hash function, prg, etc.
-template <std::size_t M, class Item, std::size_t N, class Hash, class Key, class PRG>
-pmh_tables<M, Hash> constexpr make_pmh_tables(const carray<Item, N> &
-                                                               items,
-                                                           Hash const &hash,
-                                                           Key const &key,
-                                                           PRG prg) {
-  // Step 1: Place all of the keys into buckets
-  auto step_one = make_pmh_buckets<M>(items, hash, key, prg);
-
-  // Step 2: Sort the buckets to process the ones with the most items first.
-  auto buckets = step_one.get_sorted_buckets();
-
-  // G becomes the first hash table in the resulting pmh function
-  carray<seed_or_index, M> G; // Default constructed to "index 0"
-
-  // H becomes the second hash table in the resulting pmh function
-  constexpr std::size_t UNUSED = -1;
-  carray<std::size_t, M> H;
-  H.fill(UNUSED);
-
-  // Step 3: Map the items in buckets into hash tables.
-  for (const auto & bucket : buckets) {
-    auto const bsize = bucket.size();
-
-    if (bsize == 1) {
-      // Store index to the (single) item in G
-      // assert(bucket.hash == hash(key(items[bucket[0]]), step_one.seed) % M);
-      G[bucket.hash] = {false, static_cast<uint64_t>(bucket[0])};
-    } else if (bsize > 1) {
-
-      // Repeatedly try different H of d until we find a hash function
-      // that places all items in the bucket into free slots
-      seed_or_index d{true, prg()};
-      cvector<std::size_t, decltype(step_one)::bucket_max> bucket_slots;
-
-      while (bucket_slots.size() < bsize) {
-        auto slot = hash(key(items[bucket[bucket_slots.size()]]), static_cast<size_t>(d.value())) % M;
-
-        if (H[slot] != UNUSED || !all_different_from(bucket_slots, slot)) {
-          bucket_slots.clear();
-          d = {true, prg()};
-          continue;
+// Result of a pmh policy: the items, possibly reordered, and the tables
+// that map a key to its index in these items.
+template <class Container, class Tables>
+struct pmh_build {
+  Container items;
+  Tables tables;
+};
+
+// Runs tables.lookup(*it) for every key of [first, last), and calls
+// f(*it, index) in order. A group of keys is hashed and has its tables
+// prefetched, then their items are located and prefetched, and only then are
+// keys compared, so that the cache misses of the group overlap.
+template <std::size_t N, class Tables, class Items, class ForwardIt, class F>
+void pmh_lookup_many(Tables const &tables, Items const &items, ForwardIt first,
+                     ForwardIt last, F &&f) {
+  constexpr std::size_t group = 16;
+  uint64_t hashes[group];
+  std::size_t indices[group];
+  while (first != last) {
+    std::size_t n = 0;
+    for (auto it = first; n < group && it != last; ++it, ++n) {
+      hashes[n] = tables.hash(*it);
+      tables.prefetch(hashes[n]);
+    }
+    for (std::size_t i = 0; i < n; ++i) {
+      indices[i] = tables.lookup_hash(hashes[i]);
+      if (indices[i] != N)
+        FROZEN_PREFETCH(&items[indices[i]]);
+    }
+    for (std::size_t i = 0; i < n; ++i, ++first)
+      f(*first, indices[i]);
+  }
+}
+
+// Result of the first steps of pmh construction: the first seed, the first
+// table and the item placed in each of the S slots of the second level, or -1.
+template <std::size_t M, std::size_t S, class SeedOrIndex>
+struct pmh_placement {
+  static constexpr std::size_t unused = -1;
+
+  uint64_t seed;
+  carray<SeedOrIndex, M> first_table;
+  carray<std::size_t, S> slots;
+};
+
+// Places the items of multi-item buckets in S slots, through the seed stored
+// for their bucket in the first table. Single-item buckets store the index of
+// their item, or when SingletonSlots is set, of a free slot given to the item.
+// Only the first count items are placed, see make_pmh_buckets.
+// Gives up once Budget is exhausted, see pmh_budget.
+template <std::size_t M, std::size_t S, bool SingletonSlots, class Budget,
+          class SeedOrIndex, class Item, std::size_t N, class Hash, class Key, class PRG>
+pmh_placement<M, S, SeedOrIndex> constexpr place_pmh_buckets(const carray<Item, N> & items,
+                                                             Hash const &hash,
+                                                             Key const &key,
+                                                             PRG & prg,
+                                                             std::size_t count = N) {
+  using placement_type = pmh_placement<M, S, SeedOrIndex>;
+  constexpr std::size_t UNUSED = placement_type::unused;
+
+  // Continue until every bucket is placed, with a new global seed each time
+  for (std::size_t reseed = 0; reseed < Budget::reseeds; ++reseed) {
+    // Step 1: Place all of the keys into buckets, keeping their base hash
+    carray<uint64_t, N> hashes;
+    auto step_one = make_pmh_buckets<M>(items, hash, key, hashes, prg, Budget::reseeds, count);
+
+    // Step 2: Process the buckets with the most items first, see
+    // pmh_buckets::order.
+
+    // G becomes the first hash table in the resulting pmh function
+    carray<SeedOrIndex, M> G;
+    G.fill({false, 0});
+
+    // H becomes the second hash table in the resulting pmh function
+    carray<std::size_t, S> H;
+    H.fill(UNUSED);
+
+    // Step 3: Map the items in buckets into hash tables.
+    bool placed_all = true;
+    std::size_t next_free = 0;
+    for (std::size_t rank = 0; rank < M; ++rank) {
+      auto const bucket = step_one.bucket(rank);
+      auto const bsize = bucket.size();
+
+      if (bsize == 0) {
+        // Only empty buckets are left
+        break;
+      } else if (bsize == 1) {
+        // Store index to the (single) item in G, or to the slot it gets.
+        // Multi-item buckets come first, so the free slots are known here.
+        // assert(bucket.hash == pmh_reduce<M>(hashes[bucket[0]]));
+        if (SingletonSlots) {
+          while (H[next_free] != UNUSED)
+            ++next_free;
+          H[next_free] = bucket[0];
+          G[bucket.hash] = {false, static_cast<uint64_t>(next_free)};
+        } else {
+          G[bucket.hash] = {false, static_cast<uint64_t>(bucket[0])};
+        }
+      } else if (bsize > 1) {
+
+        // Repeatedly try different H of d until we find a hash function
+        // that places all items in the bucket into free slots
+        SeedOrIndex d{true, prg()};
+        cvector<std::size_t, decltype(step_one)::bucket_max> bucket_slots;
+        std::size_t attempts = 1;
+
+        while (bucket_slots.size() < bsize) {
+          auto slot = pmh_reduce<S>(pmh_remix(hashes[bucket[bucket_slots.size()]], d.value()));
+
+          if (H[slot] != UNUSED || !all_different_from(bucket_slots, slot)) {
+            bucket_slots.clear();
+            if (attempts++ == Budget::bucket_attempts)
+              break;
+            d = {true, prg()};
+            continue;
+          }
+
+          bucket_slots.push_back(slot);
         }
 
-        bucket_slots.push_back(slot);
-      }
+        if (bucket_slots.size() < bsize) {
+          placed_all = false;
+          break;
+        }
 
-      // Put successful seed in G, and put indices to items in their slots
-      // assert(bucket.hash == hash(key(items[bucket[0]]), step_one.seed) % M);
-      G[bucket.hash] = d;
-      for (std::size_t i = 0; i < bsize; ++i)
-        H[bucket_slots[i]] = bucket[i];
+        // Put successful seed in G, and put indices to items in their slots
+        // assert(bucket.hash == pmh_reduce<M>(hashes[bucket[0]]));
+        G[bucket.hash] = d;
+        for (std::size_t i = 0; i < bsize; ++i)
+          H[bucket_slots[i]] = bucket[i];
+      }
     }
+    if (placed_all)
+      return {step_one.seed, G, H};
   }
+  pmh_placement_phase_exceeded_budget();
+  return {};
+}
+
+// Make pmh tables for given items, hash function, prg, etc.
+// Only the first count items are placed, see make_pmh_buckets.
+// Gives up once Budget is exhausted, see pmh_budget.
+template <std::size_t M, class Budget = pmh_default_budget, class Item, std::size_t N,
+          class Hash, class Key, class PRG>
+pmh_tables<M, N, Hash> constexpr make_pmh_tables(const carray<Item, N> &
+                                                               items,
+                                                           Hash const &hash,
+                                                           Key const &key,
+                                                           PRG prg,
+                                                           std::size_t count = N) {
+  using tables_type = pmh_tables<M, N, Hash>;
+  using index_type = typename tables_type::index_type;
+
+  auto const placement =
+      place_pmh_buckets<M, M, false, Budget, typename tables_type::seed_or_index_type>(
+          items, hash, key, prg, count);
 
   // Any unused entries in the H table have to get changed to zero.
   // This is because hashing should not fail or return an out-of-bounds entry.
   // A lookup fails after we apply user-supplied KeyEqual to the query and the
   // key found by hashing. Sending such queries to zero cannot hurt.
+  carray<index_type, M> narrow_H;
   for (std::size_t i = 0; i < M; ++i)
-    if (H[i] == UNUSED)
-      H[i] = 0;
+    narrow_H[i] = static_cast<index_type>(
+        placement.slots[i] == placement.unused ? 0 : placement.slots[i]);
 
-  return {step_one.seed, G, H, hash};
+  return {placement.seed, placement.first_table, narrow_H, hash};
+}
+
+// Represents the perfect hash function of the slot ordered layout, which maps
+// keys straight to the N slots where items are stored, without a second table.
+template <std::size_t M, std::size_t N, class Hasher>
+struct pmh_slot_tables {
+  using seed_or_index_type = typename pmh_table_types<M, N>::seed_or_index_type;
+
+  static constexpr std::size_t storage_size = M;
+
+  uint64_t first_seed_;
+  carray<seed_or_index_type, M> first_table_;
+  Hasher hash_;
+
+  // Hashes a given key, once per lookup
+  template <typename KeyType>
+  constexpr uint64_t hash(const KeyType & key) const {
+    return static_cast<uint64_t>(hash_(key, static_cast<size_t>(first_seed_)));
+  }
+
+  // Prefetches the first table entry of a key with hash h
+  void prefetch(uint64_t h) const { FROZEN_PREFETCH(&first_table_[pmh_reduce<M>(h)]); }
+
+  // Finds the expected index in carray<Item, N> of a key with hash h
+  constexpr std::size_t lookup_hash(uint64_t h) const {
+    auto const d = first_table_[pmh_reduce<M>(h)];
+    if (!d.is_seed()) { return static_cast<std::size_t>(d.value()); }
+    else { return pmh_reduce<N>(pmh_remix(h, d.value())); }
+  }
+
+  // Looks up a given key, to find its expected index in carray<Item, N>
+  // Always returns a valid index, must use KeyEqual test after to confirm.
+  template <typename KeyType>
+  constexpr std::size_t lookup(const KeyType & key) const {
+    return lookup_hash(hash(key));
+  }
+};
+
+// Make slot ordered pmh tables for given items, hash function, prg, etc.
+// The returned items are reordered so that each one sits at its slot.
+template <std::size_t M, class Budget = pmh_default_budget, class Item, std::size_t N,
+          class Hash, class Key, class PRG>
+pmh_build<carray<Item, N>, pmh_slot_tables<M, N, Hash>> constexpr make_pmh_slot_tables(
+    const carray<Item, N> &items, Hash const &hash, Key const &key, PRG prg) {
+  using tables_type = pmh_slot_tables<M, N, Hash>;
+
+  // There are as many slots as items, so every slot gets an item
+  auto const placement =
+      place_pmh_buckets<M, N, true, Budget, typename tables_type::seed_or_index_type>(
+          items, hash, key, prg);
+
+  return {permute(items, placement.slots), {placement.seed, placement.first_table, hash}};
 }
 
 } // namespace bits
 
+// Storage policies give the number of slots of the pmh tables for N items.
+
+// Default storage, rounded to a power of two so that range reduction is a mask
+struct pmh_default_storage {
+  static constexpr std::size_t size(std::size_t n) {
+    return bits::next_highest_power_of_two(n) * (n < 32 ? 2 : 1); // size adjustment to prevent high collision rate for small sets
+  }
+};
+
+// Storage with N * 100 / Percent slots. Singleton buckets do not use a slot of
+// the second table, so construction still converges for a load of 100%.
+template <std::size_t Percent>
+struct pmh_load_factor {
+  static_assert(0 < Percent && Percent <= 100, "load factor must be in (0, 100]");
+  static constexpr std::size_t size(std::size_t n) {
+    return n ? (n * 100 + Percent - 1) / Percent : 1;
+  }
+};
+
+using pmh_minimal_storage = pmh_load_factor<100>;
+
+// Policies select how unordered containers build their perfect hash function.
+// A policy provides a tables_type<N, Hash> with a lookup(key) method returning
+// an index into the items, and a make() function building the tables, which
+// may reorder the items.
+
+// Two-level scheme, keeps items in their original order and uses two tables
+// of Storage::size(N) slots. Construction gives up after Budget is exhausted.
+template <class Storage, class Budget = pmh_default_budget>
+struct basic_hanov_pmh {
+  template <std::size_t N, class Hash>
+  using tables_type = bits::pmh_tables<Storage::size(N), N, Hash>;
+
+  template <class Item, std::size_t N, class Hash, class Key, class PRG>
+  static constexpr bits::pmh_build<bits::carray<Item, N>, tables_type<N, Hash>>
+  make(bits::carray<Item, N> const &items, Hash const &hash, Key const &key, PRG prg) {
+    return {items, bits::make_pmh_tables<Storage::size(N), Budget>(items, hash, key, prg)};
+  }
+};
+
+// Default policy
+using hanov_pmh = basic_hanov_pmh<pmh_default_storage>;
+
+// Minimal policy, as many slots as items
+using minimal_pmh = basic_hanov_pmh<pmh_minimal_storage>;
+
+// Same first table as basic_hanov_pmh, but items are reordered so that keys of
+// multi-item buckets hash straight to their item, and single-item buckets
+// point to it. This saves the second table and one dependent load per lookup.
+template <class Storage, class Budget = pmh_default_budget>
+struct basic_slot_ordered_pmh {
+  template <std::size_t N, class Hash>
+  using tables_type = bits::pmh_slot_tables<Storage::size(N), N, Hash>;
+
+  template <class Item, std::size_t N, class Hash, class Key, class PRG>
+  static constexpr bits::pmh_build<bits::carray<Item, N>, tables_type<N, Hash>>
+  make(bits::carray<Item, N> const &items, Hash const &hash, Key const &key, PRG prg) {
+    return bits::make_pmh_slot_tables<Storage::size(N), Budget>(items, hash, key, prg);
+  }
+};
+
+using slot_ordered_pmh = basic_slot_ordered_pmh<pmh_default_storage>;
+
+namespace bits {
+
+// Fingerprint of a key with hash h. It is taken from the top bits of a remix
+// of h, so that keys sent to the same item rarely share their fingerprint.
+template <class Fingerprint>
+constexpr Fingerprint pmh_fingerprint(uint64_t h) {
+  return static_cast<Fingerprint>(mix64(h) >> (64 - 8 * sizeof(Fingerprint)));
+}
+
+// Tables of another policy, along with the fingerprint of each item. Keys
+// whose fingerprint differs from the one of their item are known to be absent.
+template <class Tables, std::size_t N, class Fingerprint>
+struct pmh_fingerprint_tables : Tables {
+  carray<Fingerprint, N> fingerprints_;
+
+  constexpr pmh_fingerprint_tables(Tables const &tables,
+                                   carray<Fingerprint, N> const &fingerprints)
+      : Tables(tables), fingerprints_(fingerprints) {}
+
+  // Finds the expected index in carray<Item, N> of a key with hash h, or N
+  // if the fingerprints differ
+  constexpr std::size_t lookup_hash(uint64_t h) const {
+    auto const index = Tables::lookup_hash(h);
+    return index != N && fingerprints_[index] == pmh_fingerprint<Fingerprint>(h) ? index : N;
+  }
+
+  // Looks up a given key, to find its expected index in carray<Item, N>
+  // Returns N or a valid index, must use KeyEqual test after to confirm.
+  template <typename KeyType>
+  constexpr std::size_t lookup(const KeyType & key) const {
+    return lookup_hash(this->hash(key));
+  }
+};
+
+} // namespace bits
+
+// Adds an 8 or 16 bit fingerprint per item to the tables of Policy, checked
+// before KeyEqual, so that most misses are rejected without reading the key.
+template <class Policy, class Fingerprint = std::uint8_t>
+struct fingerprint_pmh {
+  static_assert(std::is_unsigned<Fingerprint>::value, "fingerprints are unsigned integers");
+
+  template <std::size_t N, class Hash>
+  using tables_type = bits::pmh_fingerprint_tables<
+      typename Policy::template tables_type<N, Hash>, N, Fingerprint>;
+
+  template <class Item, std::size_t N, class Hash, class Key, class PRG>
+  static constexpr bits::pmh_build<bits::carray<Item, N>, tables_type<N, Hash>>
+  make(bits::carray<Item, N> const &items, Hash const &hash, Key const &key, PRG prg) {
+    auto const built = Policy::make(items, hash, key, prg);
+    bits::carray<Fingerprint, N> fingerprints;
+    for (std::size_t i = 0; i < N; ++i)
+      fingerprints[i] = bits::pmh_fingerprint<Fingerprint>(built.tables.hash(key(built.items[i])));
+    return {built.items, {built.tables, fingerprints}};
+  }
+};
+
+namespace bits {
+
+// Tables of another policy, along with a direct lookup table of Slots entries.
+// When the integer keys span fewer than Slots values, the hash of a key is its
+// distance to the smallest key, and its entry gives its index, or N if it is
+// absent. Otherwise, the tables of the other policy are used.
+template <class Tables, std::size_t N, std::size_t Slots>
+struct pmh_dense_tables : Tables {
+  using index_type = typename pmh_table_types<Slots, N>::index_type;
+
+  bool dense_;
+  uint64_t min_;
+  carray<index_type, Slots> slots_;
+
+  constexpr pmh_dense_tables(Tables const &tables, bool dense, uint64_t min,
+                             carray<index_type, Slots> const &slots)
+      : Tables(tables), dense_(dense), min_(min), slots_(slots) {}
+
+  // Hashes a given key, once per lookup
+  template <typename KeyType>
+  constexpr uint64_t hash(const KeyType & key) const {
+    return dense_ ? dense_ordinal(key) - min_ : Tables::hash(key);
+  }
+
+  // Prefetches the entry of a key with hash h
+  void prefetch(uint64_t h) const {
+    if (!dense_)
+      Tables::prefetch(h);
+    else if (h < Slots)
+      FROZEN_PREFETCH(&slots_[h]);
+  }
+
+  // Finds the expected index in carray<Item, N> of a key with hash h, or N
+  constexpr std::size_t lookup_hash(uint64_t h) const {
+    if (!dense_)
+      return Tables::lookup_hash(h);
+    return h < Slots ? static_cast<std::size_t>(slots_[h]) : N;
+  }
+
+  // Looks up a given key, to find its expected index in carray<Item, N>
+  // Returns N or a valid index, must use KeyEqual test after to confirm.
+  template <typename KeyType>
+  constexpr std::size_t lookup(const KeyType & key) const {
+    return lookup_hash(hash(key));
+  }
+};
+
+} // namespace bits
+
+// Integer or enum keys that span fewer than Factor * N values are looked up
+// in a direct table, with a subtraction, a bounds check and one load. Other
+// keys use the tables of Policy. The direct table is part of the container in
+// both cases, which costs Factor * N indices.
+template <class Policy = hanov_pmh, std::size_t Factor = 2>
+struct dense_pmh {
+  static_assert(Factor > 0, "the direct table needs at least N entries");
+
+  template <std::size_t N, class Hash>
+  using tables_type = bits::pmh_dense_tables<
+      typename Policy::template tables_type<N, Hash>, N, Factor * N>;
+
+  template <class Item, std::size_t N, class Hash, class Key, class PRG>
+  static constexpr bits::pmh_build<bits::carray<Item, N>, tables_type<N, Hash>>
+  make(bits::carray<Item, N> const &items, Hash const &hash, Key const &key, PRG prg) {
+    using key_type = std::decay_t<decltype(key(items[0]))>;
+    static_assert(std::is_integral<key_type>::value || std::is_enum<key_type>::value,
+                  "dense_pmh only supports integral and enum keys");
+    using index_type = typename tables_type<N, Hash>::index_type;
+
+    auto const built = Policy::make(items, hash, key, prg);
+    uint64_t min = bits::dense_ordinal(key(built.items[0]));
+    uint64_t max = min;
+    for (std::size_t i = 1; i < N; ++i) {
+      auto const ordinal = bits::dense_ordinal(key(built.items[i]));
+      min = ordinal < min ? ordinal : min;
+      max = ordinal > max ? ordinal : max;
+    }
+
+    bool const dense = max - min < Factor * N;
+    bits::carray<index_type, Factor * N> slots;
+    for (std::size_t i = 0; i < Factor * N; ++i)
+      slots[i] = static_cast<index_type>(N);
+    if (dense)
+      for (std::size_t i = 0; i < N; ++i)
+        slots[bits::dense_ordinal(key(built.items[i])) - min] = static_cast<index_type>(i);
+    return {built.items, {built.tables, dense, min, slots}};
+  }
+};
+
 } // namespace frozen
 
 #endif
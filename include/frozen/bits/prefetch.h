@@ -0,0 +1,63 @@
+/*
+ * Frozen
+ * Copyright 2016 QuarksLab
+ *
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#ifndef FROZEN_LETITGO_PREFETCH_H
+#define FROZEN_LETITGO_PREFETCH_H
+
+#include <type_traits>
+
+// Tells constant evaluation from runtime evaluation, when the compiler can
+#if defined(__cpp_lib_is_constant_evaluated)
+#define FROZEN_LETITGO_IS_CONSTANT_EVALUATED() std::is_constant_evaluated()
+#elif defined(__has_builtin)
+#if __has_builtin(__builtin_is_constant_evaluated)
+#define FROZEN_LETITGO_IS_CONSTANT_EVALUATED() __builtin_is_constant_evaluated()
+#endif
+#endif
+
+// Hints that the memory at addr will be read soon. Only used outside of
+// constant evaluation, by the batched lookups.
+#if defined(__GNUC__) || defined(__clang__)
+
+#define FROZEN_PREFETCH(addr) __builtin_prefetch(addr)
+
+#elif defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+
+#include <xmmintrin.h>
+#define FROZEN_PREFETCH(addr) _mm_prefetch(reinterpret_cast<char const *>(addr), _MM_HINT_T0)
+
+#else
+
+#define FROZEN_PREFETCH(addr) ((void)(addr))
+
+#endif
+
+// Same as FROZEN_PREFETCH, for constexpr functions: does nothing during
+// constant evaluation, or when it cannot be told from runtime evaluation.
+#if defined(FROZEN_LETITGO_IS_CONSTANT_EVALUATED)
+#define FROZEN_CONSTEXPR_PREFETCH(addr)                                        \
+  (FROZEN_LETITGO_IS_CONSTANT_EVALUATED() ? (void)(addr) : FROZEN_PREFETCH(addr))
+#else
+#define FROZEN_CONSTEXPR_PREFETCH(addr) ((void)(addr))
+#endif
+
+#endif
@@ -0,0 +1,244 @@
+/*
+ * Frozen
+ * Copyright 2016 QuarksLab
+ *
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+// inspired from PTHash: Revisiting FCH Minimal Perfect Hashing,
+// Pibiri & Trani, SIGIR 2021
+#ifndef FROZEN_LETITGO_PTHASH_H
+#define FROZEN_LETITGO_PTHASH_H
+
+#include "frozen/bits/algorithms.h"
+#include "frozen/bits/basic_types.h"
+#include "frozen/bits/pmh.h"
+
+namespace frozen {
+
+namespace bits {
+
+// Keys are first hashed into buckets, then each bucket gets a small pilot
+// value such that mixing the key hash with the pilot sends every key of the
+// bucket to a free position.
+template <std::size_t N>
+struct pthash_sizes {
+  // Average number of keys per bucket, each bucket costs one pilot byte
+  static constexpr std::size_t bucket_load = 3;
+  static constexpr std::size_t buckets = (N + bucket_load - 1) / bucket_load;
+
+  // Positions are drawn from slightly more than N slots, so that the last
+  // buckets still find a one byte pilot. Positions past N are remapped to the
+  // slots below N left free.
+  static constexpr std::size_t positions = N + N / 8 + 1;
+
+  // Pilots are stored in a byte, a bucket that cannot be placed with any of
+  // them, or within the budget, triggers a new global seed.
+  static constexpr std::size_t max_pilot = 256;
+};
+
+constexpr std::size_t pthash_bucket(uint64_t h, std::size_t buckets) {
+  return fastrange(h * 0x9e3779b97f4a7c15ULL, buckets);
+}
+
+constexpr std::size_t pthash_position(uint64_t h, std::size_t pilot,
+                                      std::size_t positions) {
+  return fastrange(mix64(h ^ (static_cast<uint64_t>(pilot) * 0xc6a4a7935bd1e995ULL)), positions);
+}
+
+// Represents the perfect hash function created by the pthash algorithm.
+// Items are expected to be stored in position order.
+template <std::size_t N, class Hasher>
+struct pthash_tables {
+  using sizes = pthash_sizes<N>;
+  using index_type = select_uint_least_t<log(N) + 1>;
+  using pilot_type = select_uint_least_t<log(sizes::max_pilot - 1) + 1>;
+
+  static constexpr std::size_t storage_size = sizes::positions;
+
+  uint64_t seed_;
+  carray<pilot_type, sizes::buckets> pilots_;
+  carray<index_type, sizes::positions - N> remap_;
+  Hasher hash_;
+
+  // Hashes a given key, once per lookup
+  template <typename KeyType>
+  constexpr uint64_t hash(const KeyType & key) const {
+    return static_cast<uint64_t>(hash_(key, static_cast<std::size_t>(seed_)));
+  }
+
+  // Prefetches the pilot of a key with hash h
+  void prefetch(uint64_t h) const { FROZEN_PREFETCH(&pilots_[pthash_bucket(h, sizes::buckets)]); }
+
+  // Finds the expected index in carray<Item, N> of a key with hash h
+  constexpr std::size_t lookup_hash(uint64_t h) const {
+    auto const pos = pthash_position(h, pilots_[pthash_bucket(h, sizes::buckets)], sizes::positions);
+    return pos < N ? pos : remap_[pos - N];
+  }
+
+  // Looks up a given key, to find its expected index in carray<Item, N>
+  // Always returns a valid index, must use KeyEqual test after to confirm.
+  template <typename KeyType>
+  constexpr std::size_t lookup(const KeyType & key) const {
+    return lookup_hash(hash(key));
+  }
+};
+
+// Called when no global seed lets every bucket find a pilot, see
+// pmh_bucket_phase_exceeded_budget.
+inline void pmh_pilot_phase_exceeded_budget() {
+  FROZEN_THROW_OR_ABORT(std::runtime_error("pthash: no seed finds a pilot for every bucket"));
+}
+
+// Make pthash tables for given items, hash function, prg, etc.
+// The returned items are reordered so that each one sits at its position.
+// Gives up once Budget is exhausted, see pmh_budget.
+template <class Budget = pmh_default_budget, class Item, std::size_t N, class Hash,
+          class Key, class PRG>
+pmh_build<carray<Item, N>, pthash_tables<N, Hash>> constexpr make_pthash_tables(
+    const carray<Item, N> &items, Hash const &hash, Key const &key, PRG prg) {
+  using sizes = pthash_sizes<N>;
+  using tables_type = pthash_tables<N, Hash>;
+  using pilot_type = typename tables_type::pilot_type;
+  using index_type = typename tables_type::index_type;
+  constexpr std::size_t B = sizes::buckets;
+  constexpr std::size_t P = sizes::positions;
+  constexpr std::size_t max_pilot =
+      sizes::max_pilot < Budget::bucket_attempts ? sizes::max_pilot : Budget::bucket_attempts;
+
+  // Continue until every bucket finds a pilot
+  for (std::size_t reseed = 0; reseed < Budget::reseeds; ++reseed) {
+    auto const seed = prg();
+
+    // Step 1: Hash every key once, and gather the items of each bucket in a
+    // flat array, bucket b owning [offsets[b], offsets[b + 1])
+    carray<uint64_t, N> hashes;
+    carray<std::size_t, B + 1> offsets;
+    offsets.fill(0);
+    for (std::size_t i = 0; i < N; ++i) {
+      hashes[i] = static_cast<uint64_t>(hash(key(items[i]), static_cast<std::size_t>(seed)));
+      offsets[pthash_bucket(hashes[i], B) + 1] += 1;
+    }
+    for (std::size_t b = 0; b < B; ++b)
+      offsets[b + 1] += offsets[b];
+
+    carray<std::size_t, N> members;
+    carray<std::size_t, B + 1> cursor = offsets;
+    for (std::size_t i = 0; i < N; ++i)
+      members[cursor[pthash_bucket(hashes[i], B)]++] = i;
+
+    // Step 2: Process the buckets with the most items first, using a counting
+    // sort on bucket sizes
+    carray<std::size_t, N + 2> by_size;
+    by_size.fill(0);
+    for (std::size_t b = 0; b < B; ++b)
+      by_size[N - (offsets[b + 1] - offsets[b]) + 1] += 1;
+    for (std::size_t s = 0; s <= N; ++s)
+      by_size[s + 1] += by_size[s];
+    carray<std::size_t, B> order;
+    for (std::size_t b = 0; b < B; ++b)
+      order[by_size[N - (offsets[b + 1] - offsets[b])]++] = b;
+
+    // Step 3: Find the smallest pilot placing each bucket in free positions
+    carray<bool, P> taken;
+    taken.fill(false);
+    carray<std::size_t, N> position_of;
+    carray<pilot_type, B> pilots;
+    pilots.fill(0);
+    bool placed_all = true;
+
+    for (std::size_t k = 0; k < B && placed_all; ++k) {
+      auto const b = order[k];
+      auto const first = offsets[b], last = offsets[b + 1];
+      if (first == last)
+        break; // remaining buckets are empty too
+
+      bool placed = false;
+      for (std::size_t pilot = 0; pilot < max_pilot && !placed; ++pilot) {
+        auto j = first;
+        for (; j < last; ++j) {
+          auto const pos = pthash_position(hashes[members[j]], pilot, P);
+          if (taken[pos])
+            break;
+          taken[pos] = true;
+          position_of[members[j]] = pos;
+        }
+        if (j == last) {
+          pilots[b] = static_cast<pilot_type>(pilot);
+          placed = true;
+        } else {
+          while (j-- != first)
+            taken[position_of[members[j]]] = false;
+        }
+      }
+      placed_all = placed;
+    }
+    if (!placed_all)
+      continue;
+
+    // Step 4: Positions past N are remapped to the free slots below N, in
+    // increasing order. Unused remap entries point to zero, a lookup ending
+    // there fails on the KeyEqual test.
+    carray<index_type, P - N> remap;
+    remap.fill(0);
+    std::size_t next_free = 0;
+    for (std::size_t pos = N; pos < P; ++pos) {
+      if (!taken[pos])
+        continue;
+      while (taken[next_free])
+        ++next_free;
+      remap[pos - N] = static_cast<index_type>(next_free);
+      taken[next_free] = true;
+      ++next_free;
+    }
+
+    carray<std::size_t, N> arrangement;
+    for (std::size_t i = 0; i < N; ++i) {
+      auto const pos = position_of[i];
+      arrangement[pos < N ? pos : remap[pos - N]] = i;
+    }
+
+    return {permute(items, arrangement), {seed, pilots, remap, hash}};
+  }
+  pmh_pilot_phase_exceeded_budget();
+  return {items, {0, {}, {}, hash}};
+}
+
+} // namespace bits
+
+// Compact policy, inspired from PTHash: a single hash and a one byte pilot
+// per bucket of about three keys are enough to locate an item. Items are
+// reordered by position, so iteration order differs from insertion order.
+// Construction gives up after Budget is exhausted.
+template <class Budget = pmh_default_budget>
+struct basic_pthash_pmh {
+  template <std::size_t N, class Hash>
+  using tables_type = bits::pthash_tables<N, Hash>;
+
+  template <class Item, std::size_t N, class Hash, class Key, class PRG>
+  static constexpr bits::pmh_build<bits::carray<Item, N>, tables_type<N, Hash>>
+  make(bits::carray<Item, N> const &items, Hash const &hash, Key const &key, PRG prg) {
+    return bits::make_pthash_tables<Budget>(items, hash, key, prg);
+  }
+};
+
+using pthash_pmh = basic_pthash_pmh<>;
+
+} // namespace frozen
+
+#endif
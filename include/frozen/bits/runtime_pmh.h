@@ -0,0 +1,297 @@
+/*
+ * Frozen
+ * Copyright 2016 QuarksLab
+ *
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+// Runtime counterpart of bits/pthash.h, for key sets too large to be hashed
+// in a constant expression. Pilots are bit packed with the width of the
+// largest one, which is not known before construction.
+#ifndef FROZEN_LETITGO_RUNTIME_PMH_H
+#define FROZEN_LETITGO_RUNTIME_PMH_H
+
+#include "frozen/bits/algorithms.h"
+#include "frozen/bits/exceptions.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <vector>
+
+namespace frozen {
+
+namespace bits {
+
+// Fixed width unsigned integers packed in 64 bit words
+class compact_vector {
+  std::vector<uint64_t> words_;
+  std::size_t width_ = 0;
+  uint64_t mask_ = 0;
+
+public:
+  compact_vector() = default;
+  compact_vector(std::size_t size, std::size_t width)
+      : words_((size * width + 63) / 64 + 1) // one extra word for straddling reads
+      , width_(width)
+      , mask_(width == 64 ? ~uint64_t(0) : (uint64_t(1) << width) - 1) {}
+
+  // Number of bits needed to store value
+  static std::size_t width_for(uint64_t value) {
+    std::size_t width = 0;
+    while (value) {
+      ++width;
+      value >>= 1;
+    }
+    return width;
+  }
+
+  uint64_t operator[](std::size_t i) const {
+    auto const pos = i * width_;
+    auto const word = pos / 64, shift = pos % 64;
+    uint64_t value = words_[word] >> shift;
+    if (shift + width_ > 64)
+      value |= words_[word + 1] << (64 - shift);
+    return value & mask_;
+  }
+
+  void set(std::size_t i, uint64_t value) {
+    auto const pos = i * width_;
+    auto const word = pos / 64, shift = pos % 64;
+    words_[word] = (words_[word] & ~(mask_ << shift)) | ((value & mask_) << shift);
+    if (shift + width_ > 64) {
+      auto const high = 64 - shift;
+      words_[word + 1] = (words_[word + 1] & ~(mask_ >> high)) | ((value & mask_) >> high);
+    }
+  }
+
+  std::size_t width() const { return width_; }
+  std::size_t bit_size() const { return words_.size() * 64; }
+};
+
+// Called when runtime_pthash runs out of seeds, see
+// pmh_placement_phase_exceeded_budget
+inline void runtime_pthash_exceeded_budget() {
+  FROZEN_THROW_OR_ABORT(std::runtime_error("pmh: no seed finds a pilot for every bucket"));
+}
+
+// Minimal perfect hash function built at runtime, PTHash style: keys are
+// hashed once into skewed buckets, and each bucket stores the pilot that sends
+// its keys to free positions.
+template <class Hasher>
+class runtime_pthash {
+  // Average number of keys per bucket, and ratio of keys to positions
+  static constexpr std::size_t bucket_load = 6;
+  static constexpr std::size_t load_factor_percent = 99;
+  // Pilots searched before trying another global seed, and global seeds
+  // tried before giving up, as many as pmh_default_budget
+  static constexpr uint64_t max_pilot = uint64_t(1) << 20;
+  static constexpr std::size_t max_reseeds = 16;
+
+  uint64_t seed_ = 0;
+  std::size_t size_ = 0;
+  std::size_t positions_ = 0;
+  std::size_t buckets_ = 0;
+  std::size_t dense_buckets_ = 0;
+  compact_vector dense_pilots_;
+  compact_vector sparse_pilots_;
+  compact_vector remap_;
+  Hasher hash_;
+
+  // 60% of the keys go to the first 30% of the buckets, these buckets are the
+  // largest ones and get placed first, while the table is still empty.
+  std::size_t bucket(uint64_t h) const {
+    auto const x = mix64(h);
+    if (static_cast<uint32_t>(x) < static_cast<uint32_t>(0.6 * 4294967296.0))
+      return fastrange(x, dense_buckets_);
+    return dense_buckets_ + fastrange(x, buckets_ - dense_buckets_);
+  }
+
+  uint64_t pilot(std::size_t b) const {
+    return b < dense_buckets_ ? dense_pilots_[b] : sparse_pilots_[b - dense_buckets_];
+  }
+
+  static std::size_t position(uint64_t h, uint64_t pilot, std::size_t positions) {
+    return fastrange(mix64(h ^ (pilot * 0xc6a4a7935bd1e995ULL)), positions);
+  }
+
+public:
+  runtime_pthash() = default;
+
+  // Builds the function for keys key(items[0]) ... key(items[n - 1]), and
+  // returns the position of each item. Throws std::invalid_argument if the
+  // same key appears twice, and std::runtime_error if no seed finds a pilot
+  // for every bucket, e.g. when distinct keys hash alike whatever the seed.
+  template <class Items, class Key, class KeyEqual, class PRG>
+  std::vector<std::size_t> build(Items const &items, Hasher const &hash,
+                                 Key const &key, KeyEqual const &equal, PRG prg) {
+    hash_ = hash;
+    size_ = items.size();
+    if (size_ >= (std::size_t(1) << 32) / 2)
+      FROZEN_THROW_OR_ABORT(std::length_error("too many keys"));
+    positions_ = size_ ? (size_ * 100 + load_factor_percent - 1) / load_factor_percent : 1;
+    buckets_ = size_ / bucket_load + 2;
+    dense_buckets_ = buckets_ * 3 / 10 + 1;
+
+    std::vector<uint64_t> hashes(size_);
+    std::vector<uint32_t> offsets(buckets_ + 1);
+    std::vector<uint32_t> members(size_);
+    std::vector<uint32_t> order(buckets_);
+    std::vector<uint64_t> taken((positions_ + 63) / 64);
+    std::vector<std::size_t> position_of(size_);
+    std::vector<uint64_t> pilots(buckets_);
+
+    // Continue until every bucket finds a pilot
+    bool placed_all = false;
+    for (std::size_t reseed = 0; reseed < max_reseeds && !placed_all; ++reseed) {
+      seed_ = prg();
+
+      // Step 1: Hash every key once, and gather the items of each bucket in
+      // a flat array, bucket b owning [offsets[b], offsets[b + 1])
+      std::fill(offsets.begin(), offsets.end(), 0);
+      for (std::size_t i = 0; i < size_; ++i) {
+        hashes[i] = static_cast<uint64_t>(hash_(key(items[i]), static_cast<std::size_t>(seed_)));
+        offsets[bucket(hashes[i]) + 1] += 1;
+      }
+      uint32_t max_bucket_size = 0;
+      for (std::size_t b = 0; b < buckets_; ++b) {
+        max_bucket_size = std::max(max_bucket_size, offsets[b + 1]);
+        offsets[b + 1] += offsets[b];
+      }
+      {
+        std::vector<uint32_t> cursor(offsets.begin(), offsets.end() - 1);
+        for (std::size_t i = 0; i < size_; ++i)
+          members[cursor[bucket(hashes[i])]++] = static_cast<uint32_t>(i);
+      }
+
+      // Step 2: Process the buckets with the most items first, using a
+      // counting sort on bucket sizes
+      {
+        std::vector<uint32_t> by_size(max_bucket_size + 2);
+        for (std::size_t b = 0; b < buckets_; ++b)
+          by_size[max_bucket_size - (offsets[b + 1] - offsets[b]) + 1] += 1;
+        for (std::size_t s = 0; s <= max_bucket_size; ++s)
+          by_size[s + 1] += by_size[s];
+        for (std::size_t b = 0; b < buckets_; ++b)
+          order[by_size[max_bucket_size - (offsets[b + 1] - offsets[b])]++] = static_cast<uint32_t>(b);
+      }
+
+      // Step 3: Find the smallest pilot placing each bucket in free positions
+      std::fill(taken.begin(), taken.end(), 0);
+      std::fill(pilots.begin(), pilots.end(), 0);
+      placed_all = true;
+
+      for (std::size_t k = 0; k < buckets_ && placed_all; ++k) {
+        auto const b = order[k];
+        auto const first = offsets[b], last = offsets[b + 1];
+        if (first == last)
+          break; // remaining buckets are empty too
+
+        bool placed = false;
+        for (uint64_t p = 0; p < max_pilot && !placed; ++p) {
+          auto j = first;
+          for (; j < last; ++j) {
+            auto const pos = position(hashes[members[j]], p, positions_);
+            auto const bit = uint64_t(1) << (pos % 64);
+            if (taken[pos / 64] & bit)
+              break;
+            taken[pos / 64] |= bit;
+            position_of[members[j]] = pos;
+          }
+          if (j == last) {
+            pilots[b] = p;
+            placed = true;
+          } else {
+            while (j-- != first)
+              taken[position_of[members[j]] / 64] &= ~(uint64_t(1) << (position_of[members[j]] % 64));
+          }
+        }
+
+        if (!placed) {
+          // Either two keys share their hash, which another seed fixes, or
+          // they are the same key
+          for (auto i = first; i < last; ++i)
+            for (auto j = i + 1; j < last; ++j)
+              if (hashes[members[i]] == hashes[members[j]] &&
+                  equal(key(items[members[i]]), key(items[members[j]])))
+                FROZEN_THROW_OR_ABORT(std::invalid_argument("duplicate key"));
+          placed_all = false;
+        }
+      }
+    }
+    if (!placed_all)
+      runtime_pthash_exceeded_budget();
+
+    // Step 4: Pack pilots, dense and sparse buckets get their own width
+    uint64_t max_dense = 0, max_sparse = 0;
+    for (std::size_t b = 0; b < dense_buckets_; ++b)
+      max_dense = std::max(max_dense, pilots[b]);
+    for (std::size_t b = dense_buckets_; b < buckets_; ++b)
+      max_sparse = std::max(max_sparse, pilots[b]);
+    dense_pilots_ = compact_vector(dense_buckets_, compact_vector::width_for(max_dense));
+    sparse_pilots_ = compact_vector(buckets_ - dense_buckets_, compact_vector::width_for(max_sparse));
+    for (std::size_t b = 0; b < buckets_; ++b) {
+      if (b < dense_buckets_)
+        dense_pilots_.set(b, pilots[b]);
+      else
+        sparse_pilots_.set(b - dense_buckets_, pilots[b]);
+    }
+
+    // Step 5: Positions past size_ are remapped to the free slots below it, in
+    // increasing order. Unused remap entries point to zero, a lookup ending
+    // there fails on the KeyEqual test.
+    remap_ = compact_vector(positions_ - size_, compact_vector::width_for(size_));
+    std::size_t next_free = 0;
+    for (std::size_t pos = size_; pos < positions_; ++pos) {
+      if (!(taken[pos / 64] & (uint64_t(1) << (pos % 64))))
+        continue;
+      while (taken[next_free / 64] & (uint64_t(1) << (next_free % 64)))
+        ++next_free;
+      remap_.set(pos - size_, next_free);
+      taken[next_free / 64] |= uint64_t(1) << (next_free % 64);
+      ++next_free;
+    }
+    for (auto &pos : position_of)
+      if (pos >= size_)
+        pos = static_cast<std::size_t>(remap_[pos - size_]);
+    return position_of;
+  }
+
+  // Looks up a given key, to find its expected index in the items
+  // Always returns a valid index when not empty, must use KeyEqual test after
+  // to confirm.
+  template <typename KeyType>
+  std::size_t lookup(const KeyType &key) const {
+    auto const h = static_cast<uint64_t>(hash_(key, static_cast<std::size_t>(seed_)));
+    auto const pos = position(h, pilot(bucket(h)), positions_);
+    return pos < size_ ? pos : static_cast<std::size_t>(remap_[pos - size_]);
+  }
+
+  Hasher const &hash_function() const { return hash_; }
+
+  // Memory used by the function itself, in bits
+  std::size_t bit_size() const {
+    return dense_pilots_.bit_size() + sparse_pilots_.bit_size() + remap_.bit_size() +
+           8 * sizeof(*this);
+  }
+};
+
+} // namespace bits
+
+} // namespace frozen
+
+#endif
@@ -0,0 +1,148 @@
+/*
+ * Frozen
+ * Copyright 2016 QuarksLab
+ *
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#ifndef FROZEN_LETITGO_BITS_SIMD_H
+#define FROZEN_LETITGO_BITS_SIMD_H
+
+#include "frozen/bits/prefetch.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <type_traits>
+
+// Integer keys are compared with SSE2 at runtime, or AVX2 when the target has
+// it, e.g. with -mavx2; constant evaluation, and other targets, use scalar code.
+#if defined(FROZEN_LETITGO_IS_CONSTANT_EVALUATED) &&                           \
+    (defined(__GNUC__) || defined(__clang__)) && defined(__SSE2__)
+#include <immintrin.h>
+#define FROZEN_LETITGO_HAS_SIMD
+#endif
+
+namespace frozen {
+
+namespace bits {
+
+// Key types compared by scan_find
+template <class Key>
+using has_simd_keys = std::integral_constant<
+    bool, (std::is_integral<Key>::value || std::is_enum<Key>::value) && !std::is_same<Key, bool>::value &&
+              (sizeof(Key) == 4 || sizeof(Key) == 8)>;
+
+// Containers of at most this many bytes of keys find them by comparing all of
+// them at once rather than by searching or hashing: 32 keys of 32 bits, eight
+// SSE2 vectors, see BM_IntCount in bench_lookup_many.cpp. The bound does not
+// depend on the target: whether a container scans decides what it stores, and
+// translation units built with and without -mavx2 must agree on it.
+constexpr std::size_t scan_max_bytes = 128;
+
+// Whether a container of N keys of type Key finds them with scan_find
+template <class Key, std::size_t N>
+using is_scannable =
+    std::integral_constant<bool, has_simd_keys<Key>::value && (N > 0) && (N * sizeof(Key) <= scan_max_bytes)>;
+
+#ifdef FROZEN_LETITGO_HAS_SIMD
+
+// Bit i of the result is set if keys[i] == value, for the simd_width<Key>()
+// keys at keys
+template <class Key>
+unsigned simd_equal_mask(Key const *keys, Key value, std::integral_constant<std::size_t, 4>) {
+#ifdef __AVX2__
+  __m256i const x = _mm256_set1_epi32(static_cast<int>(value));
+  __m256i const k = _mm256_loadu_si256(reinterpret_cast<__m256i const *>(keys));
+  return static_cast<unsigned>(_mm256_movemask_ps(_mm256_castsi256_ps(_mm256_cmpeq_epi32(x, k))));
+#else
+  __m128i const x = _mm_set1_epi32(static_cast<int>(value));
+  __m128i const k = _mm_loadu_si128(reinterpret_cast<__m128i const *>(keys));
+  return static_cast<unsigned>(_mm_movemask_ps(_mm_castsi128_ps(_mm_cmpeq_epi32(x, k))));
+#endif
+}
+
+template <class Key>
+unsigned simd_equal_mask(Key const *keys, Key value, std::integral_constant<std::size_t, 8>) {
+#ifdef __AVX2__
+  __m256i const x = _mm256_set1_epi64x(static_cast<long long>(value));
+  __m256i const k = _mm256_loadu_si256(reinterpret_cast<__m256i const *>(keys));
+  return static_cast<unsigned>(_mm256_movemask_pd(_mm256_castsi256_pd(_mm256_cmpeq_epi64(x, k))));
+#else
+  // both halves of a 64 bit lane must be equal
+  __m128i const x = _mm_set1_epi64x(static_cast<long long>(value));
+  __m128i const k = _mm_loadu_si128(reinterpret_cast<__m128i const *>(keys));
+  __m128i const halves = _mm_cmpeq_epi32(x, k);
+  __m128i const lanes = _mm_and_si128(halves, _mm_shuffle_epi32(halves, _MM_SHUFFLE(2, 3, 0, 1)));
+  return static_cast<unsigned>(_mm_movemask_pd(_mm_castsi128_pd(lanes)));
+#endif
+}
+
+template <class Key>
+constexpr std::size_t simd_width() {
+#ifdef __AVX2__
+  return 32 / sizeof(Key);
+#else
+  return 16 / sizeof(Key);
+#endif
+}
+
+// Index of value among the N keys at keys, or N. Every key is compared,
+// without branches; a last partial vector overlaps the previous one.
+template <std::size_t N, class Key>
+std::size_t simd_scan_find(Key const *keys, Key value, std::true_type /* vectors */) {
+  constexpr std::size_t W = simd_width<Key>();
+  static_assert(N <= 64, "the equality mask holds 64 keys");
+  using size = std::integral_constant<std::size_t, sizeof(Key)>;
+  uint64_t mask = 0;
+  std::size_t i = 0;
+  for (; i + W <= N; i += W)
+    mask |= static_cast<uint64_t>(simd_equal_mask(keys + i, value, size{})) << i;
+  if (i < N)
+    mask |= static_cast<uint64_t>(simd_equal_mask(keys + (N - W), value, size{})) << (N - W);
+  return mask ? static_cast<std::size_t>(__builtin_ctzll(mask)) : N;
+}
+
+// Fewer keys than a vector holds
+template <std::size_t N, class Key>
+std::size_t simd_scan_find(Key const *keys, Key value, std::false_type /* vectors */) {
+  std::size_t index = N;
+  for (std::size_t i = N; i-- > 0;)
+    index = keys[i] == value ? i : index;
+  return index;
+}
+
+#endif
+
+// Index of value among the N keys at keys, or N
+template <std::size_t N, class Key>
+constexpr std::size_t scan_find(Key const *keys, Key const &value) {
+#ifdef FROZEN_LETITGO_HAS_SIMD
+  if (!FROZEN_LETITGO_IS_CONSTANT_EVALUATED())
+    return simd_scan_find<N>(keys, value, std::integral_constant<bool, (N >= simd_width<Key>())>{});
+#endif
+  for (std::size_t i = 0; i < N; ++i)
+    if (keys[i] == value)
+      return i;
+  return N;
+}
+
+} // namespace bits
+
+} // namespace frozen
+
+#endif
@@ -0,0 +1,188 @@
+/*
+ * Frozen
+ * Copyright 2016 QuarksLab
+ *
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#ifndef FROZEN_LETITGO_BITS_SOA_H
+#define FROZEN_LETITGO_BITS_SOA_H
+
+#include "frozen/bits/algorithms.h"
+#include "frozen/bits/basic_types.h"
+
+#include <cstddef>
+#include <iterator>
+#include <type_traits>
+#include <utility>
+
+namespace frozen {
+
+namespace bits {
+
+// Iterates over the keys and values of a soa_array. It yields pairs of
+// references rather than references to pairs.
+template <class Key, class Value>
+class soa_iterator {
+  Key const *keys_;
+  Value const *values_;
+  std::ptrdiff_t index_;
+
+public:
+  using iterator_category = std::random_access_iterator_tag;
+  using value_type = std::pair<Key, Value>;
+  using difference_type = std::ptrdiff_t;
+  using reference = std::pair<Key const &, Value const &>;
+
+  // What operator-> points to: a pair of references, held by value
+  class pointer {
+    reference item_;
+
+  public:
+    constexpr explicit pointer(reference item) : item_(item) {}
+    constexpr reference const *operator->() const { return &item_; }
+  };
+
+  constexpr soa_iterator() : keys_(nullptr), values_(nullptr), index_(0) {}
+  constexpr soa_iterator(Key const *keys, Value const *values, std::ptrdiff_t index)
+      : keys_(keys), values_(values), index_(index) {}
+
+  constexpr reference operator*() const { return {keys_[index_], values_[index_]}; }
+  constexpr pointer operator->() const { return pointer{**this}; }
+  constexpr reference operator[](difference_type n) const { return *(*this + n); }
+
+  constexpr soa_iterator &operator++() { ++index_; return *this; }
+  constexpr soa_iterator &operator--() { --index_; return *this; }
+  constexpr soa_iterator operator++(int) { auto self = *this; ++*this; return self; }
+  constexpr soa_iterator operator--(int) { auto self = *this; --*this; return self; }
+  constexpr soa_iterator &operator+=(difference_type n) { index_ += n; return *this; }
+  constexpr soa_iterator &operator-=(difference_type n) { index_ -= n; return *this; }
+
+  constexpr soa_iterator operator+(difference_type n) const { auto self = *this; return self += n; }
+  constexpr soa_iterator operator-(difference_type n) const { auto self = *this; return self -= n; }
+  friend constexpr soa_iterator operator+(difference_type n, soa_iterator const &it) { return it + n; }
+  constexpr difference_type operator-(soa_iterator const &other) const { return index_ - other.index_; }
+
+  constexpr bool operator==(soa_iterator const &other) const { return index_ == other.index_; }
+  constexpr bool operator!=(soa_iterator const &other) const { return index_ != other.index_; }
+  constexpr bool operator<(soa_iterator const &other) const { return index_ < other.index_; }
+  constexpr bool operator<=(soa_iterator const &other) const { return index_ <= other.index_; }
+  constexpr bool operator>(soa_iterator const &other) const { return index_ > other.index_; }
+  constexpr bool operator>=(soa_iterator const &other) const { return index_ >= other.index_; }
+};
+
+// Keys or values of N pairs. Types that can be default constructed are
+// copied in a loop, others through a pack expansion.
+template <class T, class Pair, std::size_t N, class Project, std::size_t... Is>
+constexpr carray<T, N> soa_split(carray<Pair, N> const &items, Project const &project,
+                                 std::false_type /* default constructible */, std::index_sequence<Is...>) {
+  return carray<T, N>{project(items[Is])...};
+}
+
+template <class T, class Pair, std::size_t N, class Project>
+constexpr carray<T, N> soa_split(carray<Pair, N> const &items, Project const &project,
+                                 std::true_type /* default constructible */, std::index_sequence<>) {
+  carray<T, N> result;
+  for (std::size_t i = 0; i < N; ++i)
+    cassign(result[i], project(items[i]));
+  return result;
+}
+
+template <class T, class Pair, std::size_t N, class Project>
+constexpr carray<T, N> soa_split(carray<Pair, N> const &items, Project const &project) {
+  using default_constructible = std::is_default_constructible<T>;
+  using sequence = std::conditional_t<default_constructible::value, std::index_sequence<>,
+                                      std::make_index_sequence<N>>;
+  return soa_split<T>(items, project, default_constructible{}, sequence{});
+}
+
+struct soa_first {
+  template <class Pair>
+  constexpr typename Pair::first_type const &operator()(Pair const &item) const { return item.first; }
+};
+
+struct soa_second {
+  template <class Pair>
+  constexpr typename Pair::second_type const &operator()(Pair const &item) const { return item.second; }
+};
+
+// Key and value pairs stored as an array of keys and an array of values, so
+// that a search or the check of a hashed key reads keys only
+template <class Key, class Value, std::size_t N>
+class soa_array {
+  carray<Key, N> keys_;
+  carray<Value, N> values_;
+
+public:
+  using value_type = std::pair<Key, Value>;
+  using size_type = std::size_t;
+  using difference_type = std::ptrdiff_t;
+  using const_iterator = soa_iterator<Key, Value>;
+  using const_reverse_iterator = std::reverse_iterator<const_iterator>;
+  using const_reference = typename const_iterator::reference;
+
+  constexpr soa_array(carray<value_type, N> const &items)
+      : keys_(soa_split<Key>(items, soa_first{})), values_(soa_split<Value>(items, soa_second{})) {}
+
+  constexpr const_iterator begin() const { return {keys_.begin(), values_.begin(), 0}; }
+  constexpr const_iterator end() const { return {keys_.begin(), values_.begin(), static_cast<std::ptrdiff_t>(N)}; }
+  constexpr const_iterator cbegin() const { return begin(); }
+  constexpr const_iterator cend() const { return end(); }
+  constexpr const_reverse_iterator rbegin() const { return const_reverse_iterator(end()); }
+  constexpr const_reverse_iterator rend() const { return const_reverse_iterator(begin()); }
+  constexpr const_reverse_iterator crbegin() const { return rbegin(); }
+  constexpr const_reverse_iterator crend() const { return rend(); }
+
+  constexpr const_reference operator[](std::size_t index) const { return {keys_[index], values_[index]}; }
+  constexpr carray<Key, N> const &keys() const { return keys_; }
+
+  // First item not lower than value, or end(), searched among the keys
+  template <class T, class Compare>
+  constexpr const_iterator lower_bound(T const &value, Compare const &compare) const {
+    return begin() + (bits::lower_bound<N>(keys_.begin(), value, compare) - keys_.begin());
+  }
+};
+
+// Storage of soa_layout: an array of keys alone for sets
+template <class Key, class Item, std::size_t N>
+struct soa_storage {
+  using type = soa_array<Key, typename Item::second_type, N>;
+};
+
+template <class Key, std::size_t N>
+struct soa_storage<Key, Key, N> {
+  using type = carray<Key, N>;
+};
+
+// Keys of the items of a container, as an array: the items themselves, or
+// the keys of a soa_array
+template <class Item, std::size_t N>
+constexpr carray<Item, N> const &item_keys(carray<Item, N> const &items) {
+  return items;
+}
+
+template <class Key, class Value, std::size_t N>
+constexpr carray<Key, N> const &item_keys(soa_array<Key, Value, N> const &items) {
+  return items.keys();
+}
+
+} // namespace bits
+
+} // namespace frozen
+
+#endif
@@ -0,0 +1,369 @@
+/*
+ * Frozen
+ * Copyright 2016 QuarksLab
+ *
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#ifndef FROZEN_LETITGO_BITS_STREE_H
+#define FROZEN_LETITGO_BITS_STREE_H
+
+#include "frozen/bits/algorithms.h"
+#include "frozen/bits/basic_types.h"
+#include "frozen/bits/prefetch.h"
+#include "frozen/bits/simd.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <iterator>
+#include <type_traits>
+#include <utility>
+
+namespace frozen {
+
+namespace bits {
+
+// Key of the items of a container of keys of type Key: the item itself, or
+// the first member of a pair
+template <class Key>
+struct key_of {
+  constexpr Key const &operator()(Key const &key) const { return key; }
+  template <class Value>
+  constexpr Key const &operator()(std::pair<Key, Value> const &item) const { return item.first; }
+};
+
+// Keys per node of an S-tree; 16 keys of 32 bits fill a cache line. Nodes are
+// not aligned to cache lines, see pmh_block.
+constexpr std::size_t stree_node_size = 16;
+
+template <std::size_t N>
+struct stree_shape {
+  static constexpr std::size_t nodes = (N + stree_node_size - 1) / stree_node_size;
+  static constexpr std::size_t slots = nodes * stree_node_size;
+};
+
+// Visits node and its subtrees in order, giving the next rank to each slot.
+// Node k holds slots k * B to k * B + B - 1, and its children are nodes
+// k * (B + 1) + 1 to k * (B + 1) + B + 1.
+template <std::size_t Slots>
+constexpr void stree_rank_subtree(carray<std::size_t, Slots> &ranks, std::size_t node, std::size_t &rank) {
+  constexpr std::size_t B = stree_node_size;
+  if (node >= Slots / B)
+    return;
+  for (std::size_t i = 0; i < B; ++i) {
+    stree_rank_subtree(ranks, node * (B + 1) + i + 1, rank);
+    ranks[node * B + i] = rank++;
+  }
+  stree_rank_subtree(ranks, node * (B + 1) + B + 1, rank);
+}
+
+// In order rank of every slot of an S-tree; slots ranked N or more are padding
+template <std::size_t Slots>
+constexpr carray<std::size_t, Slots> stree_ranks() {
+  carray<std::size_t, Slots> ranks;
+  std::size_t rank = 0;
+  stree_rank_subtree(ranks, 0, rank);
+  return ranks;
+}
+
+// Result whose i-th element is project(sorted[min(ranks[i], N - 1)]): padding
+// repeats the last item, so that it never comes before a real one
+template <class T, std::size_t Slots, class Item, std::size_t N, class Project, std::size_t... Is>
+constexpr carray<T, Slots> stree_gather(carray<Item, N> const &sorted, carray<std::size_t, Slots> const &ranks,
+                                        Project const &project, std::false_type /* default constructible */,
+                                        std::index_sequence<Is...>) {
+  return carray<T, Slots>{project(sorted[ranks[Is] < N ? ranks[Is] : N - 1])...};
+}
+
+template <class T, std::size_t Slots, class Item, std::size_t N, class Project>
+constexpr carray<T, Slots> stree_gather(carray<Item, N> const &sorted, carray<std::size_t, Slots> const &ranks,
+                                        Project const &project, std::true_type /* default constructible */,
+                                        std::index_sequence<>) {
+  carray<T, Slots> result;
+  for (std::size_t i = 0; i < Slots; ++i)
+    cassign(result[i], project(sorted[ranks[i] < N ? ranks[i] : N - 1]));
+  return result;
+}
+
+template <class T, std::size_t Slots, class Item, std::size_t N, class Project>
+constexpr carray<T, Slots> stree_gather(carray<Item, N> const &sorted, carray<std::size_t, Slots> const &ranks,
+                                        Project const &project) {
+  using default_constructible = std::is_default_constructible<T>;
+  using sequence = std::conditional_t<default_constructible::value, std::index_sequence<>,
+                                      std::make_index_sequence<Slots>>;
+  return stree_gather<T>(sorted, ranks, project, default_constructible{}, sequence{});
+}
+
+// Keys and items of an S-tree, stored once when they are the same
+template <class Key, class Item, std::size_t Slots>
+struct stree_items {
+  carray<Key, Slots> keys_;
+  carray<Item, Slots> items_;
+
+  template <std::size_t N>
+  constexpr stree_items(carray<Item, N> const &sorted, carray<std::size_t, Slots> const &ranks)
+      : keys_(stree_gather<Key>(sorted, ranks, key_of<Key>{})),
+        items_(stree_gather<Item>(sorted, ranks, key_of<Item>{})) {}
+
+  constexpr Key const *keys() const { return keys_.begin(); }
+  constexpr Item const *items() const { return items_.begin(); }
+};
+
+template <class Key, std::size_t Slots>
+struct stree_items<Key, Key, Slots> {
+  carray<Key, Slots> keys_;
+
+  template <std::size_t N>
+  constexpr stree_items(carray<Key, N> const &sorted, carray<std::size_t, Slots> const &ranks)
+      : keys_(stree_gather<Key>(sorted, ranks, key_of<Key>{})) {}
+
+  constexpr Key const *keys() const { return keys_.begin(); }
+  constexpr Key const *items() const { return keys_.begin(); }
+};
+
+// Number of the keys of a node lower than value
+template <class Key, class T, class Compare>
+constexpr std::size_t stree_count_lower(Key const *keys, T const &value, Compare const &compare) {
+  std::size_t count = 0;
+  for (std::size_t i = 0; i < stree_node_size; ++i)
+    count += compare(keys[i], value);
+  return count;
+}
+
+#ifdef FROZEN_LETITGO_HAS_SIMD
+
+// Same, for signed integers, or unsigned ones biased by their sign bit
+template <class Key>
+std::size_t stree_simd_count_lower(Key const *keys, Key value, std::integral_constant<std::size_t, 4>) {
+  constexpr std::size_t B = stree_node_size;
+  int const bias = std::is_signed<Key>::value ? 0 : INT32_MIN;
+  unsigned mask = 0;
+#ifdef __AVX2__
+  __m256i const biases = _mm256_set1_epi32(bias);
+  __m256i const x = _mm256_set1_epi32(static_cast<int>(value) ^ bias);
+  for (std::size_t i = 0; i < B; i += 8) {
+    __m256i const k = _mm256_xor_si256(_mm256_loadu_si256(reinterpret_cast<__m256i const *>(keys + i)), biases);
+    mask |= static_cast<unsigned>(_mm256_movemask_ps(_mm256_castsi256_ps(_mm256_cmpgt_epi32(x, k)))) << i;
+  }
+#else
+  __m128i const biases = _mm_set1_epi32(bias);
+  __m128i const x = _mm_set1_epi32(static_cast<int>(value) ^ bias);
+  for (std::size_t i = 0; i < B; i += 4) {
+    __m128i const k = _mm_xor_si128(_mm_loadu_si128(reinterpret_cast<__m128i const *>(keys + i)), biases);
+    mask |= static_cast<unsigned>(_mm_movemask_ps(_mm_castsi128_ps(_mm_cmpgt_epi32(x, k)))) << i;
+  }
+#endif
+  return static_cast<std::size_t>(__builtin_ctz(~mask)); // keys are sorted
+}
+
+#ifdef __AVX2__
+template <class Key>
+std::size_t stree_simd_count_lower(Key const *keys, Key value, std::integral_constant<std::size_t, 8>) {
+  constexpr std::size_t B = stree_node_size;
+  long long const bias = std::is_signed<Key>::value ? 0 : INT64_MIN;
+  __m256i const biases = _mm256_set1_epi64x(bias);
+  __m256i const x = _mm256_set1_epi64x(static_cast<long long>(value) ^ bias);
+  unsigned mask = 0;
+  for (std::size_t i = 0; i < B; i += 4) {
+    __m256i const k = _mm256_xor_si256(_mm256_loadu_si256(reinterpret_cast<__m256i const *>(keys + i)), biases);
+    mask |= static_cast<unsigned>(_mm256_movemask_pd(_mm256_castsi256_pd(_mm256_cmpgt_epi64(x, k)))) << i;
+  }
+  return static_cast<std::size_t>(__builtin_ctz(~mask)); // keys are sorted
+}
+#endif
+
+// Key types whose nodes have a SIMD search
+template <class Key>
+using has_simd_nodes = std::integral_constant<
+    bool, std::is_integral<Key>::value && !std::is_same<Key, bool>::value &&
+              (sizeof(Key) == 4
+#ifdef __AVX2__
+               || sizeof(Key) == 8
+#endif
+               )>;
+
+#else
+
+template <class Key>
+using has_simd_nodes = std::false_type;
+
+#endif
+
+// Iterates over the items of an S-tree in sorted order. It holds a slot,
+// Slots past the end, and moves through the rank of every slot and the slot
+// of every rank.
+template <class Item, class Index, std::size_t N, std::size_t Slots>
+class stree_iterator {
+  Item const *items_;
+  Index const *ranks_;
+  Index const *slots_;
+  std::size_t slot_;
+
+  constexpr std::ptrdiff_t rank() const {
+    return static_cast<std::ptrdiff_t>(slot_ == Slots ? N : ranks_[slot_]);
+  }
+
+  constexpr void seek(std::ptrdiff_t rank) {
+    slot_ = static_cast<std::size_t>(rank) < N ? slots_[rank] : Slots;
+  }
+
+public:
+  using iterator_category = std::random_access_iterator_tag;
+  using value_type = Item;
+  using difference_type = std::ptrdiff_t;
+  using pointer = Item const *;
+  using reference = Item const &;
+
+  constexpr stree_iterator() : items_(nullptr), ranks_(nullptr), slots_(nullptr), slot_(Slots) {}
+  constexpr stree_iterator(Item const *items, Index const *ranks, Index const *slots, std::size_t slot)
+      : items_(items), ranks_(ranks), slots_(slots), slot_(slot) {}
+
+  constexpr reference operator*() const { return items_[slot_]; }
+  constexpr pointer operator->() const { return &items_[slot_]; }
+  constexpr reference operator[](difference_type n) const { return *(*this + n); }
+
+  constexpr stree_iterator &operator++() { seek(rank() + 1); return *this; }
+  constexpr stree_iterator &operator--() { seek(rank() - 1); return *this; }
+  constexpr stree_iterator operator++(int) { auto self = *this; ++*this; return self; }
+  constexpr stree_iterator operator--(int) { auto self = *this; --*this; return self; }
+  constexpr stree_iterator &operator+=(difference_type n) { seek(rank() + n); return *this; }
+  constexpr stree_iterator &operator-=(difference_type n) { seek(rank() - n); return *this; }
+
+  constexpr stree_iterator operator+(difference_type n) const { auto self = *this; return self += n; }
+  constexpr stree_iterator operator-(difference_type n) const { auto self = *this; return self -= n; }
+  friend constexpr stree_iterator operator+(difference_type n, stree_iterator const &it) { return it + n; }
+  constexpr difference_type operator-(stree_iterator const &other) const { return rank() - other.rank(); }
+
+  constexpr bool operator==(stree_iterator const &other) const { return slot_ == other.slot_; }
+  constexpr bool operator!=(stree_iterator const &other) const { return slot_ != other.slot_; }
+  constexpr bool operator<(stree_iterator const &other) const { return rank() < other.rank(); }
+  constexpr bool operator<=(stree_iterator const &other) const { return rank() <= other.rank(); }
+  constexpr bool operator>(stree_iterator const &other) const { return rank() > other.rank(); }
+  constexpr bool operator>=(stree_iterator const &other) const { return rank() >= other.rank(); }
+};
+
+// Sorted items stored as a static B-tree of 16 keys per node, without
+// pointers: a search reads one node per level, i.e. log17(N) cache lines for
+// 32 bit keys, instead of log2(N) for a binary search. Keys are copied apart
+// from the items of maps, so that nodes stay contiguous.
+template <class Key, class Item, std::size_t N>
+class stree_array {
+  static constexpr std::size_t Nodes = stree_shape<N>::nodes;
+  static constexpr std::size_t Slots = stree_shape<N>::slots;
+  using index_type = select_uint_least_t<log(Slots) + 1>;
+
+  stree_items<Key, Item, Slots> items_;
+  carray<index_type, Slots> ranks_; // slot -> rank
+  carray<index_type, N> slots_;     // rank -> slot
+
+  static constexpr carray<index_type, Slots> narrow(carray<std::size_t, Slots> const &ranks) {
+    carray<index_type, Slots> narrowed;
+    for (std::size_t i = 0; i < Slots; ++i)
+      narrowed[i] = static_cast<index_type>(ranks[i] < N ? ranks[i] : N);
+    return narrowed;
+  }
+
+  static constexpr carray<index_type, N> invert(carray<std::size_t, Slots> const &ranks) {
+    carray<index_type, N> slots;
+    for (std::size_t i = 0; i < Slots; ++i)
+      if (ranks[i] < N)
+        slots[ranks[i]] = static_cast<index_type>(i);
+    return slots;
+  }
+
+  constexpr stree_array(carray<Item, N> const &sorted, carray<std::size_t, Slots> const &ranks)
+      : items_(sorted, ranks), ranks_(narrow(ranks)), slots_(invert(ranks)) {}
+
+public:
+  using value_type = Item;
+  using size_type = std::size_t;
+  using difference_type = std::ptrdiff_t;
+  using const_reference = Item const &;
+  using const_pointer = Item const *;
+  using const_iterator = stree_iterator<Item, index_type, N, Slots>;
+  using const_reverse_iterator = std::reverse_iterator<const_iterator>;
+
+  // Takes the items in sorted order
+  constexpr stree_array(carray<Item, N> const &sorted)
+      : stree_array(sorted, stree_ranks<Slots>()) {}
+
+  constexpr const_iterator begin() const { return at_slot(slots_[0]); }
+  constexpr const_iterator end() const { return at_slot(Slots); }
+  constexpr const_iterator cbegin() const { return begin(); }
+  constexpr const_iterator cend() const { return end(); }
+  constexpr const_reverse_iterator rbegin() const { return const_reverse_iterator(end()); }
+  constexpr const_reverse_iterator rend() const { return const_reverse_iterator(begin()); }
+  constexpr const_reverse_iterator crbegin() const { return rbegin(); }
+  constexpr const_reverse_iterator crend() const { return rend(); }
+
+  // First item not lower than value, or end(). Each node sends the search to
+  // the child after its keys lower than value; the answer is the last key
+  // met that is not lower.
+  template <class T, class Compare>
+  constexpr const_iterator lower_bound(T const &value, Compare const &compare) const {
+    constexpr std::size_t B = stree_node_size;
+    auto const keys = items_.keys();
+    std::size_t node = 0, found = Slots;
+    while (node < Nodes) {
+      auto const lower = count_lower(keys + node * B, value, compare);
+      found = lower < B ? node * B + lower : found;
+      node = node * (B + 1) + lower + 1;
+    }
+    return at_slot(found);
+  }
+
+private:
+  constexpr const_iterator at_slot(std::size_t slot) const {
+    return {items_.items(), ranks_.begin(), slots_.begin(), slot};
+  }
+
+  template <class T, class Compare>
+  constexpr std::size_t count_lower(Key const *keys, T const &value, Compare const &compare) const {
+#ifdef FROZEN_LETITGO_HAS_SIMD
+    return count_lower(keys, value, compare,
+                       std::integral_constant<bool, has_simd_nodes<Key>::value &&
+                                                        std::is_same<T, Key>::value &&
+                                                        is_natural_order<Compare, Key>::value>{});
+#else
+    return stree_count_lower(keys, value, compare);
+#endif
+  }
+
+#ifdef FROZEN_LETITGO_HAS_SIMD
+  template <class T, class Compare>
+  constexpr std::size_t count_lower(Key const *keys, T const &value, Compare const &compare,
+                                    std::false_type /* simd */) const {
+    return stree_count_lower(keys, value, compare);
+  }
+
+  template <class T, class Compare>
+  constexpr std::size_t count_lower(Key const *keys, T const &value, Compare const &compare,
+                                    std::true_type /* simd */) const {
+    if (!FROZEN_LETITGO_IS_CONSTANT_EVALUATED())
+      return stree_simd_count_lower(keys, value, std::integral_constant<std::size_t, sizeof(Key)>{});
+    return stree_count_lower(keys, value, compare);
+  }
+#endif
+};
+
+} // namespace bits
+
+} // namespace frozen
+
+#endif
@@ -0,0 +1,157 @@
+/*
+ * Frozen
+ * Copyright 2016 QuarksLab
+ *
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#ifndef FROZEN_LETITGO_CRC_HASH_H
+#define FROZEN_LETITGO_CRC_HASH_H
+
+#include "frozen/bits/algorithms.h"
+#include "frozen/bits/basic_types.h"
+#include "frozen/string.h"
+
+#include <cstdint>
+#include <type_traits>
+
+// The crc32 instruction of SSE4.2 is used when the target has it, e.g. with
+// -msse4.2, and a table otherwise. Both compute the same CRC32C. Its 64 bit
+// form only exists on x86-64.
+#if defined(FROZEN_LETITGO_HAS_WORD_LOADS) &&                                  \
+    ((defined(__SSE4_2__) && defined(__x86_64__)) ||                           \
+     (defined(_MSC_VER) && defined(__AVX__) && defined(_M_X64)))
+#include <nmmintrin.h>
+#define FROZEN_LETITGO_HAS_CRC32
+#endif
+
+namespace frozen {
+
+namespace bits {
+
+constexpr carray<uint32_t, 256> make_crc32c_table() {
+  carray<uint32_t, 256> table;
+  for (uint32_t i = 0; i < 256; ++i) {
+    uint32_t crc = i;
+    for (int j = 0; j < 8; ++j)
+      crc = (crc >> 1) ^ (0x82f63b78u & (0u - (crc & 1u)));
+    table[i] = crc;
+  }
+  return table;
+}
+
+template <class = void> struct crc32c_table {
+  static constexpr carray<uint32_t, 256> values = make_crc32c_table();
+};
+template <class T> constexpr carray<uint32_t, 256> crc32c_table<T>::values;
+
+// CRC32C of the eight bytes of word, lowest first, without the initial and
+// final inversions: the semantic of the crc32 instruction
+constexpr uint32_t crc32c_word(uint32_t crc, uint64_t word) {
+  for (int i = 0; i < 8; ++i)
+    crc = crc32c_table<>::values[(crc ^ static_cast<uint32_t>(word >> (8 * i))) & 0xff] ^ (crc >> 8);
+  return crc;
+}
+
+// Hashes a sequence of words with a CRC, one instruction per word at runtime,
+// next to a fold of the words by a multiplier drawn from the seed. A CRC is
+// linear, and changing its initial value only xors a constant to it, so keys
+// whose CRCs collide do so whatever the seed: the fold is not linear, and
+// depends on the order of the words and on the seed, so that a new seed
+// separates them.
+class crc_state {
+  uint32_t crc_;
+  uint64_t fold_;
+  uint64_t multiplier_;
+  uint64_t seed_;
+
+  constexpr void fold(uint64_t word) { fold_ = (fold_ + word) * multiplier_; }
+
+public:
+  constexpr crc_state(uint64_t seed, uint64_t size)
+      : crc_(static_cast<uint32_t>(mix64(seed ^ size))), fold_(size),
+        multiplier_(mix64(seed + 0x9e3779b97f4a7c15ULL) | 1), seed_(seed) {}
+
+  // Only called during constant evaluation, or without the crc32 instruction
+  constexpr void update_constexpr(uint64_t word) {
+    crc_ = crc32c_word(crc_, word);
+    fold(word);
+  }
+
+#ifdef FROZEN_LETITGO_HAS_CRC32
+  void update_runtime(uint64_t word) {
+    crc_ = static_cast<uint32_t>(_mm_crc32_u64(crc_, word));
+    fold(word);
+  }
+#endif
+
+  constexpr uint64_t digest() const {
+    return mix64((static_cast<uint64_t>(crc_) << 32 | crc_) ^ fold_ ^ (seed_ * 0xc6a4a7935bd1e995ULL));
+  }
+};
+
+} // namespace bits
+
+// Seeded hash built on CRC32C, for integral types, enums and frozen::string.
+// It is cheaper than elsa on long strings when the crc32 instruction is
+// available, and computes the same values during constant evaluation, so a
+// container built at compile time can be used at runtime.
+template <class T> struct crc_hash {
+  static_assert(std::is_integral<T>::value || std::is_enum<T>::value,
+                "only supports integral types, specialize for other types");
+
+  constexpr std::size_t operator()(T const &value, std::size_t seed) const {
+    bits::crc_state state{seed, sizeof(T)};
+    auto const word = static_cast<uint64_t>(value);
+#ifdef FROZEN_LETITGO_HAS_CRC32
+    if (!FROZEN_LETITGO_IS_CONSTANT_EVALUATED()) {
+      state.update_runtime(word);
+      return static_cast<std::size_t>(state.digest());
+    }
+#endif
+    state.update_constexpr(word);
+    return static_cast<std::size_t>(state.digest());
+  }
+};
+
+template <> struct crc_hash<string> {
+  constexpr std::size_t operator()(string value, std::size_t seed) const {
+    char const *data = value.data();
+    std::size_t const size = value.size();
+    bits::crc_state state{seed, size};
+    std::size_t i = 0;
+#ifdef FROZEN_LETITGO_HAS_CRC32
+    if (!FROZEN_LETITGO_IS_CONSTANT_EVALUATED()) {
+      for (; i + 8 <= size; i += 8)
+        state.update_runtime(bits::load_word(data + i));
+      if (i < size)
+        state.update_runtime(bits::load_tail(data, size, size - i));
+      return static_cast<std::size_t>(state.digest());
+    }
+#endif
+    for (; i + 8 <= size; i += 8)
+      state.update_constexpr(bits::load_bytes(data + i, 8));
+    if (i < size)
+      state.update_constexpr(bits::load_bytes(data + i, size - i));
+    return static_cast<std::size_t>(state.digest());
+  }
+};
+
+} // namespace frozen
+
+#endif
@@ -0,0 +1,127 @@
+/*
+ * Frozen
+ * Copyright 2016 QuarksLab
+ *
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#ifndef FROZEN_LETITGO_LENGTH_UNORDERED_MAP_H
+#define FROZEN_LETITGO_LENGTH_UNORDERED_MAP_H
+
+#include "frozen/bits/basic_types.h"
+#include "frozen/bits/constexpr_assert.h"
+#include "frozen/bits/elsa.h"
+#include "frozen/bits/exceptions.h"
+#include "frozen/bits/length_table.h"
+#include "frozen/bits/version.h"
+#include "frozen/random.h"
+#include "frozen/string.h"
+#include "frozen/unordered_map.h"
+
+#include <utility>
+
+namespace frozen {
+
+// A map from strings grouped by length, see length_unordered_set
+template <class Value, std::size_t N, typename Hash = elsa<string>>
+class length_unordered_map {
+  using container_type = bits::carray<std::pair<string, Value>, N>;
+  using table_type = bits::length_table<std::pair<string, Value>, N, Hash>;
+
+  table_type table_;
+
+public:
+  /* typedefs */
+  using key_type = string;
+  using mapped_type = Value;
+  using value_type = typename container_type::value_type;
+  using size_type = typename container_type::size_type;
+  using difference_type = typename container_type::difference_type;
+  using hasher = Hash;
+  using const_reference = typename container_type::const_reference;
+  using reference = const_reference;
+  using const_pointer = typename container_type::const_pointer;
+  using pointer = const_pointer;
+  using const_iterator = const_pointer;
+  using iterator = const_iterator;
+
+public:
+  /* constructors */
+  length_unordered_map(length_unordered_map const &) = default;
+  constexpr length_unordered_map(container_type items, Hash const &hash)
+      : table_(bits::make_length_table(items, hash, bits::GetKey{}, default_prg_t{})) {}
+  explicit constexpr length_unordered_map(container_type items)
+      : length_unordered_map{items, Hash{}} {}
+
+  constexpr length_unordered_map(std::initializer_list<value_type> items, Hash const & hash)
+      : length_unordered_map{container_type{items}, hash} {
+        constexpr_assert(items.size() == N, "Inconsistent initializer_list size and type size argument");
+      }
+
+  constexpr length_unordered_map(std::initializer_list<value_type> items)
+      : length_unordered_map{items, Hash{}} {}
+
+  /* iterators */
+  constexpr const_iterator begin() const { return table_.items.begin(); }
+  constexpr const_iterator end() const { return table_.items.end(); }
+  constexpr const_iterator cbegin() const { return table_.items.cbegin(); }
+  constexpr const_iterator cend() const { return table_.items.cend(); }
+
+  /* capacity */
+  constexpr bool empty() const { return !N; }
+  constexpr size_type size() const { return N; }
+  constexpr size_type max_size() const { return N; }
+
+  /* lookup */
+  constexpr std::size_t count(string const &key) const {
+    return find(key) != end();
+  }
+
+  constexpr Value const &at(string const &key) const {
+    auto const where = find(key);
+    if (where != end())
+      return where->second;
+    else
+      FROZEN_THROW_OR_ABORT(std::out_of_range("unknown key"));
+  }
+
+  constexpr const_iterator find(string const &key) const {
+    auto const index = table_.lookup(key, bits::GetKey{});
+    return index != N ? &table_.items[index] : end();
+  }
+
+  constexpr std::pair<const_iterator, const_iterator> equal_range(string const &key) const {
+    auto const where = find(key);
+    if (where != end())
+      return {where, where + 1};
+    else
+      return {end(), end()};
+  }
+
+  /* observers*/
+  constexpr hasher hash_function() const { return table_.tables.hash_; }
+};
+
+template <class Value, std::size_t N>
+constexpr auto make_length_unordered_map(std::pair<string, Value> const (&items)[N]) {
+  return length_unordered_map<Value, N>{items};
+}
+
+} // namespace frozen
+
+#endif
@@ -27,8 +27,10 @@
 #include "frozen/bits/basic_types.h"
 #include "frozen/bits/constexpr_assert.h"
 #include "frozen/bits/exceptions.h"
+#include "frozen/bits/layout.h"
 #include "frozen/bits/version.h"
 
+#include <iterator>
 #include <utility>
 
 namespace frozen {
@@ -61,6 +63,19 @@ public:
     return comparator_(std::get<0>(self), other_key);
   }
 
+  // pairs of references, from the iterators of soa_layout
+  template <class Key, class Value>
+  constexpr int operator()(Key const &self_key,
+                           std::pair<Key const &, Value const &> const &other) const {
+    return comparator_(self_key, std::get<0>(other));
+  }
+
+  template <class Key, class Value>
+  constexpr int operator()(std::pair<Key const &, Value const &> const &self,
+                           Key const &other_key) const {
+    return comparator_(std::get<0>(self), other_key);
+  }
+
   template <class Key>
   constexpr int operator()(Key const &self_key, Key const &other_key) const {
     return comparator_(self_key, other_key);
@@ -69,11 +84,21 @@ public:
 
 } // namespace impl
 
-template <class Key, class Value, std::size_t N, class Compare = std::less<Key>>
-class map {
+namespace bits {
+
+template <class Comparator, class Key>
+struct is_natural_order<impl::CompareKey<Comparator>, Key> : is_natural_order<Comparator, Key> {};
+
+} // namespace bits
+
+template <class Key, class Value, std::size_t N, class Compare = std::less<Key>,
+          class Layout = sorted_layout>
+class map : bits::dense_hole_count<bits::is_dense_searchable<Key, Compare>::value> {
   using container_type = bits::carray<std::pair<Key, Value>, N>;
+  using storage_type = typename Layout::template storage_type<Key, std::pair<Key, Value>, N>;
+  using hole_count = bits::dense_hole_count<bits::is_dense_searchable<Key, Compare>::value>;
   impl::CompareKey<Compare> less_than_;
-  container_type items_;
+  storage_type items_;
 
 public:
   using key_type = Key;
@@ -82,21 +107,20 @@ public:
   using size_type = typename container_type::size_type;
   using difference_type = typename container_type::difference_type;
   using key_compare = decltype(less_than_);
-  using const_reference = typename container_type::const_reference;
+  using const_iterator = typename storage_type::const_iterator;
+  using iterator = const_iterator;
+  using const_reference = typename std::iterator_traits<const_iterator>::reference;
   using reference = const_reference;
-  using const_pointer = typename container_type::const_pointer;
+  using const_pointer = typename std::iterator_traits<const_iterator>::pointer;
   using pointer = const_pointer;
-  using const_iterator = typename container_type::const_iterator;
-  using iterator = const_iterator;
   using const_reverse_iterator =
-      typename container_type::const_reverse_iterator;
+      typename storage_type::const_reverse_iterator;
   using reverse_iterator = const_reverse_iterator;
 
 public:
   /* constructors */
   constexpr map(container_type items, Compare const &compare)
-      : less_than_{compare}
-      , items_{bits::quicksort(items, less_than_)} {}
+      : map(bits::sort(items, impl::CompareKey<Compare>{compare}), compare, bits::ignored_arg{}) {}
 
   explicit constexpr map(container_type items)
       : map{items, Compare{}} {}
@@ -111,7 +135,7 @@ public:
 
   /* element access */
   constexpr mapped_type at(Key const &key) const {
-    auto const where = lower_bound(key);
+    auto const where = find(key);
     if (where != end())
       return where->second;
     else
@@ -137,15 +161,11 @@ public:
   /* lookup */
 
   constexpr std::size_t count(Key const &key) const {
-    return bits::binary_search<N>(items_.begin(), key, less_than_);
+    return find(key) != end();
   }
 
   constexpr const_iterator find(Key const &key) const {
-    const_iterator where = lower_bound(key);
-    if ((where != end()) && !less_than_(key, *where))
-      return where;
-    else
-      return end();
+    return find(key, bits::is_dense_searchable<Key, Compare>{});
   }
 
   constexpr std::pair<const_iterator, const_iterator> equal_range(Key const &key) const {
@@ -156,17 +176,50 @@ public:
       return {lower, lower + 1};
   }
 
+  // Batched lookups: write find(key), or count(key), for every key of
+  // [first, last) to out. Lookups of consecutive keys overlap their memory
+  // accesses, which pays off on containers larger than the cache.
+  template <class ForwardIt, class OutputIt>
+  OutputIt find_many(ForwardIt first, ForwardIt last, OutputIt out) const {
+    bits::layout_lower_bound_many(items_, first, last, less_than_, [&](Key const &key, const_iterator where) {
+      *out++ = (where != end()) && !less_than_(key, *where) ? where : end();
+    });
+    return out;
+  }
+
+  template <class ForwardIt, class OutputIt>
+  OutputIt count_many(ForwardIt first, ForwardIt last, OutputIt out) const {
+    bits::layout_lower_bound_many(items_, first, last, less_than_, [&](Key const &key, const_iterator where) {
+      *out++ = std::size_t((where != end()) && !less_than_(key, *where));
+    });
+    return out;
+  }
+
+  // Same, for keys in ascending order: the search of a key starts from the
+  // answer to the previous one, so that M keys cost about M log(N / M) probes
+  template <class InputIt, class OutputIt>
+  OutputIt find_sorted(InputIt first, InputIt last, OutputIt out) const {
+    bits::lower_bound_sorted<N>(items_.begin(), first, last, less_than_, [&](Key const &key, const_iterator where) {
+      *out++ = (where != end()) && !less_than_(key, *where) ? where : end();
+    });
+    return out;
+  }
+
+  template <class InputIt, class OutputIt>
+  OutputIt count_sorted(InputIt first, InputIt last, OutputIt out) const {
+    bits::lower_bound_sorted<N>(items_.begin(), first, last, less_than_, [&](Key const &key, const_iterator where) {
+      *out++ = std::size_t((where != end()) && !less_than_(key, *where));
+    });
+    return out;
+  }
+
   constexpr const_iterator lower_bound(Key const &key) const {
-    auto const where = bits::lower_bound<N>(items_.begin(), key, less_than_);
-    if ((where != end()) && !less_than_(key, *where))
-      return where;
-    else
-      return end();
+    return find(key);
   }
 
   constexpr const_iterator upper_bound(Key const &key) const {
-    auto const where = bits::lower_bound<N>(items_.begin(), key, less_than_);
-    if ((where != end()) && !less_than_(key, *where))
+    auto const where = find(key);
+    if (where != end())
       return where + 1;
     else
       return end();
@@ -175,10 +228,34 @@ public:
   /* observers */
   constexpr key_compare key_comp() const { return less_than_; }
   constexpr key_compare value_comp() const { return less_than_; }
+
+private:
+  constexpr const_iterator find(Key const &key, std::false_type /* dense */) const {
+    auto const where = bits::layout_lower_bound(items_, key, less_than_);
+    if ((where != end()) && !less_than_(key, *where))
+      return where;
+    else
+      return end();
+  }
+
+  // Integer keys with few holes are found from their distance to the first key
+  constexpr const_iterator find(Key const &key, std::true_type /* dense */) const {
+    if (this->holes() <= bits::dense_max_holes)
+      return bits::dense_find<N>(items_.begin(), key, this->holes(), bits::item_key{});
+    else
+      return find(key, std::false_type{});
+  }
+
+  // Takes the items in sorted order, before they are laid out
+  constexpr map(container_type const &sorted, Compare const &compare, bits::ignored_arg)
+      : hole_count(bits::dense_holes<N>(sorted.begin(), bits::item_key{},
+                                        bits::is_dense_searchable<Key, Compare>{}))
+      , less_than_{compare}
+      , items_{sorted} {}
 };
 
-template <class Key, class Value, class Compare>
-class map<Key, Value, 0, Compare> {
+template <class Key, class Value, class Compare, class Layout>
+class map<Key, Value, 0, Compare, Layout> {
   using container_type = bits::carray<std::pair<Key, Value>, 0>;
   impl::CompareKey<Compare> less_than_;
 
@@ -238,6 +315,30 @@ public:
     return {end(), end()};
   }
 
+  template <class ForwardIt, class OutputIt>
+  OutputIt find_many(ForwardIt first, ForwardIt last, OutputIt out) const {
+    for (; first != last; ++first)
+      *out++ = end();
+    return out;
+  }
+
+  template <class ForwardIt, class OutputIt>
+  OutputIt count_many(ForwardIt first, ForwardIt last, OutputIt out) const {
+    for (; first != last; ++first)
+      *out++ = std::size_t(0);
+    return out;
+  }
+
+  template <class InputIt, class OutputIt>
+  OutputIt find_sorted(InputIt first, InputIt last, OutputIt out) const {
+    return find_many(first, last, out);
+  }
+
+  template <class InputIt, class OutputIt>
+  OutputIt count_sorted(InputIt first, InputIt last, OutputIt out) const {
+    return count_many(first, last, out);
+  }
+
   constexpr const_iterator lower_bound(Key const &) const { return end(); }
 
   constexpr const_iterator upper_bound(Key const &) const { return end(); }
@@ -0,0 +1,146 @@
+/*
+ * Frozen
+ * Copyright 2016 QuarksLab
+ *
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#ifndef FROZEN_LETITGO_RUNTIME_UNORDERED_MAP_H
+#define FROZEN_LETITGO_RUNTIME_UNORDERED_MAP_H
+
+#include "frozen/bits/elsa.h"
+#include "frozen/bits/exceptions.h"
+#include "frozen/bits/runtime_pmh.h"
+#include "frozen/bits/version.h"
+#include "frozen/random.h"
+
+#include <functional>
+#include <initializer_list>
+#include <utility>
+#include <vector>
+
+namespace frozen {
+
+// Immutable map built at runtime, for key sets too large for constexpr
+// construction. Lookups go through a minimal perfect hash function of a few
+// bits per key, and items are stored in hash order.
+template <class Key, class Value, typename Hash = anna<Key>,
+          class KeyEqual = std::equal_to<Key>>
+class runtime_unordered_map {
+  using container_type = std::vector<std::pair<Key, Value>>;
+  using function_type = bits::runtime_pthash<Hash>;
+
+  KeyEqual equal_;
+  container_type items_;
+  function_type function_;
+
+public:
+  /* typedefs */
+  using key_type = Key;
+  using mapped_type = Value;
+  using value_type = typename container_type::value_type;
+  using size_type = typename container_type::size_type;
+  using difference_type = typename container_type::difference_type;
+  using hasher = Hash;
+  using key_equal = KeyEqual;
+  using const_reference = typename container_type::const_reference;
+  using reference = const_reference;
+  using const_pointer = typename container_type::const_pointer;
+  using pointer = const_pointer;
+  using const_iterator = typename container_type::const_iterator;
+  using iterator = const_iterator;
+
+public:
+  /* constructors */
+  runtime_unordered_map(container_type items, Hash const &hash = Hash{},
+                        KeyEqual const &equal = KeyEqual{})
+      : equal_{equal} {
+    auto const positions = function_.build(items, hash, GetKey{}, equal_, default_prg_t{});
+    std::vector<std::size_t> order(items.size());
+    for (std::size_t i = 0; i < items.size(); ++i)
+      order[positions[i]] = i;
+    items_.reserve(items.size());
+    for (auto i : order)
+      items_.push_back(std::move(items[i]));
+  }
+
+  template <class InputIt>
+  runtime_unordered_map(InputIt first, InputIt last, Hash const &hash = Hash{},
+                        KeyEqual const &equal = KeyEqual{})
+      : runtime_unordered_map{container_type(first, last), hash, equal} {}
+
+  runtime_unordered_map(std::initializer_list<value_type> items,
+                        Hash const &hash = Hash{}, KeyEqual const &equal = KeyEqual{})
+      : runtime_unordered_map{container_type(items), hash, equal} {}
+
+  /* iterators */
+  const_iterator begin() const { return items_.begin(); }
+  const_iterator end() const { return items_.end(); }
+  const_iterator cbegin() const { return items_.cbegin(); }
+  const_iterator cend() const { return items_.cend(); }
+
+  /* capacity */
+  bool empty() const { return items_.empty(); }
+  size_type size() const { return items_.size(); }
+  size_type max_size() const { return items_.size(); }
+
+  /* lookup */
+  std::size_t count(Key const &key) const { return find(key) != end(); }
+
+  Value const &at(Key const &key) const {
+    auto const where = find(key);
+    if (where != end())
+      return where->second;
+    else
+      FROZEN_THROW_OR_ABORT(std::out_of_range("unknown key"));
+  }
+
+  const_iterator find(Key const &key) const {
+    if (items_.empty())
+      return end();
+    auto const where = items_.begin() + function_.lookup(key);
+    if (equal_(where->first, key))
+      return where;
+    else
+      return end();
+  }
+
+  std::pair<const_iterator, const_iterator> equal_range(Key const &key) const {
+    auto const where = find(key);
+    if (where != end())
+      return {where, where + 1};
+    else
+      return {end(), end()};
+  }
+
+  /* observers*/
+  hasher hash_function() const { return function_.hash_function(); }
+  key_equal key_eq() const { return equal_; }
+
+  // Memory used by the perfect hash function, excluding the items, in bits
+  std::size_t function_bit_size() const { return function_.bit_size(); }
+
+private:
+  struct GetKey {
+    Key const &operator()(value_type const &kv) const { return kv.first; }
+  };
+};
+
+} // namespace frozen
+
+#endif
@@ -26,16 +26,22 @@
 #include "frozen/bits/algorithms.h"
 #include "frozen/bits/basic_types.h"
 #include "frozen/bits/constexpr_assert.h"
+#include "frozen/bits/layout.h"
+#include "frozen/bits/simd.h"
 #include "frozen/bits/version.h"
 
 #include <utility>
 
 namespace frozen {
 
-template <class Key, std::size_t N, class Compare = std::less<Key>> class set {
+template <class Key, std::size_t N, class Compare = std::less<Key>,
+          class Layout = sorted_layout>
+class set : bits::dense_hole_count<bits::is_dense_searchable<Key, Compare>::value> {
   using container_type = bits::carray<Key, N>;
+  using storage_type = typename Layout::template storage_type<Key, Key, N>;
+  using hole_count = bits::dense_hole_count<bits::is_dense_searchable<Key, Compare>::value>;
   Compare less_than_;
-  container_type keys_;
+  storage_type keys_;
 
 public:
   /* container typedefs*/
@@ -49,8 +55,8 @@ public:
   using const_reference = reference;
   using pointer = typename container_type::const_pointer;
   using const_pointer = pointer;
-  using iterator = typename container_type::const_iterator;
-  using reverse_iterator = typename container_type::const_reverse_iterator;
+  using iterator = typename storage_type::const_iterator;
+  using reverse_iterator = typename storage_type::const_reverse_iterator;
   using const_iterator = iterator;
   using const_reverse_iterator = reverse_iterator;
 
@@ -59,9 +65,7 @@ public:
   constexpr set(const set &other) = default;
 
   constexpr set(container_type keys, Compare const & comp)
-      : less_than_{comp}
-      , keys_(bits::quicksort(keys, less_than_)) {
-      }
+      : set(bits::sort(keys, comp), comp, bits::ignored_arg{}) {}
 
   explicit constexpr set(container_type keys)
       : set{keys, Compare{}} {}
@@ -81,15 +85,11 @@ public:
 
   /* lookup */
   constexpr std::size_t count(Key const &key) const {
-    return bits::binary_search<N>(keys_.begin(), key, less_than_);
+    return find(key) != end();
   }
 
   constexpr const_iterator find(Key const &key) const {
-    const_iterator where = lower_bound(key);
-    if ((where != end()) && !less_than_(key, *where))
-      return where;
-    else
-      return end();
+    return find(key, bits::is_dense_searchable<Key, Compare>{});
   }
 
   constexpr std::pair<const_iterator, const_iterator> equal_range(Key const &key) const {
@@ -100,17 +100,50 @@ public:
       return {lower, lower + 1};
   }
 
+  // Batched lookups: write find(key), or count(key), for every key of
+  // [first, last) to out. Lookups of consecutive keys overlap their memory
+  // accesses, which pays off on containers larger than the cache.
+  template <class ForwardIt, class OutputIt>
+  OutputIt find_many(ForwardIt first, ForwardIt last, OutputIt out) const {
+    bits::layout_lower_bound_many(keys_, first, last, less_than_, [&](Key const &key, const_iterator where) {
+      *out++ = (where != end()) && !less_than_(key, *where) ? where : end();
+    });
+    return out;
+  }
+
+  template <class ForwardIt, class OutputIt>
+  OutputIt count_many(ForwardIt first, ForwardIt last, OutputIt out) const {
+    bits::layout_lower_bound_many(keys_, first, last, less_than_, [&](Key const &key, const_iterator where) {
+      *out++ = std::size_t((where != end()) && !less_than_(key, *where));
+    });
+    return out;
+  }
+
+  // Same, for keys in ascending order: the search of a key starts from the
+  // answer to the previous one, so that M keys cost about M log(N / M) probes
+  template <class InputIt, class OutputIt>
+  OutputIt find_sorted(InputIt first, InputIt last, OutputIt out) const {
+    bits::lower_bound_sorted<N>(keys_.begin(), first, last, less_than_, [&](Key const &key, const_iterator where) {
+      *out++ = (where != end()) && !less_than_(key, *where) ? where : end();
+    });
+    return out;
+  }
+
+  template <class InputIt, class OutputIt>
+  OutputIt count_sorted(InputIt first, InputIt last, OutputIt out) const {
+    bits::lower_bound_sorted<N>(keys_.begin(), first, last, less_than_, [&](Key const &key, const_iterator where) {
+      *out++ = std::size_t((where != end()) && !less_than_(key, *where));
+    });
+    return out;
+  }
+
   constexpr const_iterator lower_bound(Key const &key) const {
-    auto const where = bits::lower_bound<N>(keys_.begin(), key, less_than_);
-    if ((where != end()) && !less_than_(key, *where))
-      return where;
-    else
-      return end();
+    return find(key);
   }
 
   constexpr const_iterator upper_bound(Key const &key) const {
-    auto const where = bits::lower_bound<N>(keys_.begin(), key, less_than_);
-    if ((where != end()) && !less_than_(key, *where))
+    auto const where = find(key);
+    if (where != end())
       return where + 1;
     else
       return end();
@@ -138,9 +171,46 @@ public:
   constexpr bool operator<=(set const& rhs) const { return (*this < rhs) || (*this == rhs); }
   constexpr bool operator>(set const& rhs) const { return bits::lexicographical_compare(rhs.begin(), rhs.end(), begin(), end()); }
   constexpr bool operator>=(set const& rhs) const { return (*this > rhs) || (*this == rhs); }
+
+private:
+  // Few sorted integer keys are all compared to key at once
+  using is_scannable =
+      std::integral_constant<bool, bits::is_scannable<Key, N>::value && bits::is_natural_order<Compare, Key>::value &&
+                                       std::is_same<storage_type, container_type>::value>;
+
+  constexpr const_iterator find(Key const &key, std::false_type /* dense */) const {
+    return search(key, is_scannable{});
+  }
+
+  // Integer keys with few holes are found from their distance to the first key
+  constexpr const_iterator find(Key const &key, std::true_type /* dense */) const {
+    if (this->holes() <= bits::dense_max_holes)
+      return bits::dense_find<N>(keys_.begin(), key, this->holes(), bits::item_key{});
+    else
+      return find(key, std::false_type{});
+  }
+
+  constexpr const_iterator search(Key const &key, std::false_type /* scan */) const {
+    auto const where = bits::layout_lower_bound(keys_, key, less_than_);
+    if ((where != end()) && !less_than_(key, *where))
+      return where;
+    else
+      return end();
+  }
+
+  constexpr const_iterator search(Key const &key, std::true_type /* scan */) const {
+    return keys_.begin() + bits::scan_find<N>(keys_.begin(), key);
+  }
+
+  // Takes the keys in sorted order, before they are laid out
+  constexpr set(container_type const &sorted, Compare const &comp, bits::ignored_arg)
+      : hole_count(bits::dense_holes<N>(sorted.begin(), bits::item_key{},
+                                        bits::is_dense_searchable<Key, Compare>{}))
+      , less_than_{comp}
+      , keys_(sorted) {}
 };
 
-template <class Key, class Compare> class set<Key, 0, Compare> {
+template <class Key, class Compare, class Layout> class set<Key, 0, Compare, Layout> {
   using container_type = bits::carray<Key, 0>; // just for the type definitions
   Compare less_than_;
 
@@ -184,6 +254,30 @@ public:
   constexpr std::pair<const_iterator, const_iterator>
   equal_range(Key const &) const { return {end(), end()}; }
 
+  template <class ForwardIt, class OutputIt>
+  OutputIt find_many(ForwardIt first, ForwardIt last, OutputIt out) const {
+    for (; first != last; ++first)
+      *out++ = end();
+    return out;
+  }
+
+  template <class ForwardIt, class OutputIt>
+  OutputIt count_many(ForwardIt first, ForwardIt last, OutputIt out) const {
+    for (; first != last; ++first)
+      *out++ = std::size_t(0);
+    return out;
+  }
+
+  template <class InputIt, class OutputIt>
+  OutputIt find_sorted(InputIt first, InputIt last, OutputIt out) const {
+    return find_many(first, last, out);
+  }
+
+  template <class InputIt, class OutputIt>
+  OutputIt count_sorted(InputIt first, InputIt last, OutputIt out) const {
+    return count_many(first, last, out);
+  }
+
   constexpr const_iterator lower_bound(Key const &) const { return end(); }
 
   constexpr const_iterator upper_bound(Key const &) const { return end(); }
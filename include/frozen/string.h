@@ -23,10 +23,25 @@
 #ifndef FROZEN_LETITGO_STRING_H
 #define FROZEN_LETITGO_STRING_H
 
+#include "frozen/bits/algorithms.h"
 #include "frozen/bits/elsa.h"
+#include "frozen/bits/prefetch.h"
 #include "frozen/bits/version.h"
 
+#include <cstdint>
+#include <cstring>
 #include <functional>
+#include <type_traits>
+
+// Strings are hashed a word at a time at runtime, through plain loads, and a
+// byte at a time during constant evaluation. Both read the same little-endian
+// words, so both compute the same hash. Without a way to tell them apart, or
+// on big-endian targets, bytes are always read one at a time.
+#if defined(FROZEN_LETITGO_IS_CONSTANT_EVALUATED) &&                           \
+    (defined(_MSC_VER) || (defined(__BYTE_ORDER__) &&                          \
+                           __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__))
+#define FROZEN_LETITGO_HAS_WORD_LOADS
+#endif
 
 namespace frozen {
 
@@ -74,18 +89,89 @@ public:
   constexpr const char *data() const { return data_; }
 };
 
+namespace bits {
+
+// Reads the n <= 8 bytes at data as a little-endian word
+constexpr uint64_t load_bytes(char const *data, std::size_t n) {
+  uint64_t word = 0;
+  for (std::size_t i = 0; i < n; ++i)
+    word |= static_cast<uint64_t>(static_cast<unsigned char>(data[i])) << (8 * i);
+  return word;
+}
+
+#ifdef FROZEN_LETITGO_HAS_WORD_LOADS
+inline uint64_t load_word(char const *data) {
+  uint64_t word;
+  std::memcpy(&word, data, sizeof(word));
+  return word;
+}
+
+inline uint64_t load_half_word(char const *data) {
+  uint32_t word;
+  std::memcpy(&word, data, sizeof(word));
+  return word;
+}
+
+// Same as load_bytes(data + size - n, n) for 0 < n <= 8, without reading
+// outside of [data, data + size)
+inline uint64_t load_tail(char const *data, std::size_t size, std::size_t n) {
+  if (size >= 8)
+    return load_word(data + size - 8) >> (8 * (8 - n));
+  if (n >= 4)
+    return load_half_word(data) | (load_half_word(data + n - 4) >> (8 * (8 - n))) << 32;
+  return load_bytes(data, n);
+}
+#endif
+
+// Compares the n bytes at a and b, a word at a time at runtime
+constexpr bool equal_bytes(char const *a, char const *b, std::size_t n) {
+#ifdef FROZEN_LETITGO_HAS_WORD_LOADS
+  if (!FROZEN_LETITGO_IS_CONSTANT_EVALUATED()) {
+    std::size_t i = 0;
+    for (; i + 8 <= n; i += 8)
+      if (load_word(a + i) != load_word(b + i))
+        return false;
+    return i == n || load_tail(a, n, n - i) == load_tail(b, n, n - i);
+  }
+#endif
+  for (std::size_t i = 0; i < n; ++i)
+    if (a[i] != b[i])
+      return false;
+  return true;
+}
+
+constexpr uint64_t hash_word(uint64_t h, uint64_t word) {
+  h = (h ^ word) * 0x9e3779b97f4a7c15ULL;
+  return h ^ (h >> 32);
+}
+
+} // namespace bits
+
 template <> struct elsa<string> {
   constexpr std::size_t operator()(string value) const {
-    std::size_t d = 5381;
-    for (std::size_t i = 0; i < value.size(); ++i)
-      d = d * 33 + value[i];
-    return d;
+    return (*this)(value, 0);
   }
+  // Hashes eight bytes per step, and the last zero to eight bytes as a final,
+  // shorter word
   constexpr std::size_t operator()(string value, std::size_t seed) const {
-    std::size_t d = seed;
-    for (std::size_t i = 0; i < value.size(); ++i)
-      d = (d * 0x01000193) ^ value[i];
-    return d;
+    char const *data = value.data();
+    std::size_t const size = value.size();
+    uint64_t h = static_cast<uint64_t>(seed) ^ (static_cast<uint64_t>(size) * 0xc6a4a7935bd1e995ULL);
+    std::size_t i = 0;
+#ifdef FROZEN_LETITGO_HAS_WORD_LOADS
+    if (!FROZEN_LETITGO_IS_CONSTANT_EVALUATED()) {
+      for (; i + 8 <= size; i += 8)
+        h = bits::hash_word(h, bits::load_word(data + i));
+      if (i < size)
+        h = bits::hash_word(h, bits::load_tail(data, size, size - i));
+      return static_cast<std::size_t>(bits::mix64(h));
+    }
+#endif
+    for (; i + 8 <= size; i += 8)
+      h = bits::hash_word(h, bits::load_bytes(data + i, 8));
+    if (i < size)
+      h = bits::hash_word(h, bits::load_bytes(data + i, size - i));
+    return static_cast<std::size_t>(bits::mix64(h));
   }
 };
 
@@ -28,11 +28,16 @@
 #include "frozen/bits/elsa.h"
 #include "frozen/bits/exceptions.h"
 #include "frozen/bits/pmh.h"
+#include "frozen/bits/block_pmh.h"
+#include "frozen/bits/key_position_pmh.h"
+#include "frozen/bits/layout.h"
+#include "frozen/bits/pthash.h"
 #include "frozen/bits/version.h"
 #include "frozen/random.h"
 
 #include <tuple>
 #include <functional>
+#include <iterator>
 
 namespace frozen {
 
@@ -47,15 +52,16 @@ struct GetKey {
 } // namespace bits
 
 template <class Key, class Value, std::size_t N, typename Hash = anna<Key>,
-          class KeyEqual = std::equal_to<Key>>
+          class KeyEqual = std::equal_to<Key>, class Policy = hanov_pmh,
+          class Layout = array_layout>
 class unordered_map {
-  static constexpr std::size_t storage_size =
-      bits::next_highest_power_of_two(N) * (N < 32 ? 2 : 1); // size adjustment to prevent high collision rate for small sets
   using container_type = bits::carray<std::pair<Key, Value>, N>;
-  using tables_type = bits::pmh_tables<storage_size, Hash>;
+  using storage_type = typename Layout::template storage_type<Key, std::pair<Key, Value>, N>;
+  using tables_type = typename Policy::template tables_type<N, Hash>;
+  using build_type = bits::pmh_build<container_type, tables_type>;
 
   KeyEqual const equal_;
-  container_type items_;
+  storage_type items_;
   tables_type tables_;
 
 public:
@@ -67,23 +73,20 @@ public:
   using difference_type = typename container_type::difference_type;
   using hasher = Hash;
   using key_equal = KeyEqual;
-  using const_reference = typename container_type::const_reference;
+  using const_iterator = typename storage_type::const_iterator;
+  using iterator = const_iterator;
+  using const_reference = typename std::iterator_traits<const_iterator>::reference;
   using reference = const_reference;
-  using const_pointer = typename container_type::const_pointer;
+  using const_pointer = typename std::iterator_traits<const_iterator>::pointer;
   using pointer = const_pointer;
-  using const_iterator = const_pointer;
-  using iterator = const_iterator;
 
 public:
   /* constructors */
   unordered_map(unordered_map const &) = default;
   constexpr unordered_map(container_type items,
                           Hash const &hash, KeyEqual const &equal)
-      : equal_{equal}
-      , items_{items}
-      , tables_{
-            bits::make_pmh_tables<storage_size>(
-                items_, hash, bits::GetKey{}, default_prg_t{})} {}
+      : unordered_map(Policy::make(items, hash, bits::GetKey{}, default_prg_t{}),
+                      equal) {}
   explicit constexpr unordered_map(container_type items)
       : unordered_map{items, Hash{}, KeyEqual{}} {}
 
@@ -109,46 +112,66 @@ public:
 
   /* lookup */
   constexpr std::size_t count(Key const &key) const {
-    auto const &kv = lookup(key);
-    return equal_(kv.first, key);
+    return find(key) != items_.end();
   }
 
   constexpr Value const &at(Key const &key) const {
-    auto const &kv = lookup(key);
-    if (equal_(kv.first, key))
-      return kv.second;
+    auto const where = find(key);
+    if (where != items_.end())
+      return where->second;
     else
       FROZEN_THROW_OR_ABORT(std::out_of_range("unknown key"));
   }
 
   constexpr const_iterator find(Key const &key) const {
-    auto const &kv = lookup(key);
-    if (equal_(kv.first, key))
-      return &kv;
+    // Tables return N for keys they know to be absent
+    auto const index = tables_.lookup(key);
+    if (index != N && equal_(items_[index].first, key))
+      return items_.begin() + index;
     else
       return items_.end();
   }
 
   constexpr std::pair<const_iterator, const_iterator> equal_range(Key const &key) const {
-    auto const &kv = lookup(key);
-    if (equal_(kv.first, key))
-      return {&kv, &kv + 1};
+    auto const where = find(key);
+    if (where != items_.end())
+      return {where, where + 1};
     else
       return {items_.end(), items_.end()};
   }
 
+  // Batched lookups: write find(key), or count(key), for every key of
+  // [first, last) to out. Lookups of consecutive keys overlap their memory
+  // accesses, which pays off on containers larger than the cache.
+  template <class ForwardIt, class OutputIt>
+  OutputIt find_many(ForwardIt first, ForwardIt last, OutputIt out) const {
+    bits::pmh_lookup_many<N>(tables_, bits::item_keys(items_), first, last, [&](Key const &key, std::size_t index) {
+      *out++ = index != N && equal_(items_[index].first, key) ? items_.begin() + index : items_.end();
+    });
+    return out;
+  }
+
+  template <class ForwardIt, class OutputIt>
+  OutputIt count_many(ForwardIt first, ForwardIt last, OutputIt out) const {
+    bits::pmh_lookup_many<N>(tables_, bits::item_keys(items_), first, last, [&](Key const &key, std::size_t index) {
+      *out++ = std::size_t(index != N && equal_(items_[index].first, key));
+    });
+    return out;
+  }
+
   /* bucket interface */
-  constexpr std::size_t bucket_count() const { return storage_size; }
-  constexpr std::size_t max_bucket_count() const { return storage_size; }
+  constexpr std::size_t bucket_count() const { return tables_type::storage_size; }
+  constexpr std::size_t max_bucket_count() const { return tables_type::storage_size; }
 
   /* observers*/
   constexpr hasher hash_function() const { return tables_.hash_; }
   constexpr key_equal key_eq() const { return equal_; }
 
 private:
-  constexpr auto const &lookup(Key const &key) const {
-    return items_[tables_.lookup(key)];
-  }
+  constexpr unordered_map(build_type const &built, KeyEqual const &equal)
+      : equal_{equal}
+      , items_{built.items}
+      , tables_{built.tables} {}
 };
 
 template <typename T, typename U, std::size_t N>
@@ -27,6 +27,10 @@
 #include "frozen/bits/constexpr_assert.h"
 #include "frozen/bits/elsa.h"
 #include "frozen/bits/pmh.h"
+#include "frozen/bits/block_pmh.h"
+#include "frozen/bits/key_position_pmh.h"
+#include "frozen/bits/pthash.h"
+#include "frozen/bits/simd.h"
 #include "frozen/bits/version.h"
 #include "frozen/random.h"
 
@@ -42,15 +46,44 @@ struct Get {
   }
 };
 
+// Tables of a set that scans its keys rather than hashing them: just the hash,
+// for hash_function()
+template <std::size_t N, class Hash>
+struct scan_tables {
+  static constexpr std::size_t storage_size = N;
+
+  Hash hash_;
+};
+
+// Policy of such sets, keeps the keys in their original order
+struct scan_policy {
+  template <std::size_t N, class Hash>
+  using tables_type = scan_tables<N, Hash>;
+
+  template <class Item, std::size_t N, class Hash, class Key, class PRG>
+  static constexpr pmh_build<carray<Item, N>, tables_type<N, Hash>>
+  make(carray<Item, N> const &items, Hash const &hash, Key const &, PRG) {
+    return {items, {hash}};
+  }
+};
+
 } // namespace bits
 
 template <class Key, std::size_t N, typename Hash = elsa<Key>,
-          class KeyEqual = std::equal_to<Key>>
+          class KeyEqual = std::equal_to<Key>, class Policy = hanov_pmh>
 class unordered_set {
-  static constexpr std::size_t storage_size =
-      bits::next_highest_power_of_two(N) * (N < 32 ? 2 : 1); // size adjustment to prevent high collision rate for small sets
+  // Few integer keys are all compared to key at once, rather than hashed,
+  // unless the hash, the equality or the policy is user-provided. Such sets
+  // build no tables.
+  using is_scannable =
+      std::integral_constant<bool, bits::is_scannable<Key, N>::value && std::is_same<Hash, elsa<Key>>::value &&
+                                       std::is_same<KeyEqual, std::equal_to<Key>>::value &&
+                                       std::is_same<Policy, hanov_pmh>::value>;
+
   using container_type = bits::carray<Key, N>;
-  using tables_type = bits::pmh_tables<storage_size, Hash>;
+  using policy_type = std::conditional_t<is_scannable::value, bits::scan_policy, Policy>;
+  using tables_type = typename policy_type::template tables_type<N, Hash>;
+  using build_type = bits::pmh_build<container_type, tables_type>;
 
   KeyEqual const equal_;
   container_type keys_;
@@ -76,10 +109,8 @@ public:
   unordered_set(unordered_set const &) = default;
   constexpr unordered_set(container_type keys, Hash const &hash,
                           KeyEqual const &equal)
-      : equal_{equal}
-      , keys_{keys}
-      , tables_{bits::make_pmh_tables<storage_size>(
-            keys_, hash, bits::Get{}, default_prg_t{})} {}
+      : unordered_set(policy_type::make(keys, hash, bits::Get{}, default_prg_t{}),
+                      equal) {}
   explicit constexpr unordered_set(container_type keys)
       : unordered_set{keys, Hash{}, KeyEqual{}} {}
 
@@ -104,37 +135,76 @@ public:
 
   /* lookup */
   constexpr std::size_t count(Key const &key) const {
-    auto const k = lookup(key);
-    return equal_(k, key);
+    return find(key) != keys_.end();
   }
   constexpr const_iterator find(Key const &key) const {
-    auto const &k = lookup(key);
-    if (equal_(k, key))
-      return &k;
-    else
-      return keys_.end();
+    return find(key, is_scannable{});
   }
 
   constexpr std::pair<const_iterator, const_iterator> equal_range(Key const &key) const {
-    auto const &k = lookup(key);
-    if (equal_(k, key))
-      return {&k, &k + 1};
+    auto const where = find(key);
+    if (where != keys_.end())
+      return {where, where + 1};
     else
       return {keys_.end(), keys_.end()};
   }
 
+  // Batched lookups: write find(key), or count(key), for every key of
+  // [first, last) to out. Lookups of consecutive keys overlap their memory
+  // accesses, which pays off on containers larger than the cache.
+  template <class ForwardIt, class OutputIt>
+  OutputIt find_many(ForwardIt first, ForwardIt last, OutputIt out) const {
+    lookup_many(first, last, [&](Key const &key, std::size_t index) {
+      *out++ = index != N && equal_(keys_[index], key) ? &keys_[index] : keys_.end();
+    }, is_scannable{});
+    return out;
+  }
+
+  template <class ForwardIt, class OutputIt>
+  OutputIt count_many(ForwardIt first, ForwardIt last, OutputIt out) const {
+    lookup_many(first, last, [&](Key const &key, std::size_t index) {
+      *out++ = std::size_t(index != N && equal_(keys_[index], key));
+    }, is_scannable{});
+    return out;
+  }
+
   /* bucket interface */
-  constexpr std::size_t bucket_count() const { return storage_size; }
-  constexpr std::size_t max_bucket_count() const { return storage_size; }
+  constexpr std::size_t bucket_count() const { return tables_type::storage_size; }
+  constexpr std::size_t max_bucket_count() const { return tables_type::storage_size; }
 
   /* observers*/
   constexpr hasher hash_function() const { return tables_.hash_; }
   constexpr key_equal key_eq() const { return equal_; }
 
 private:
-  constexpr auto const &lookup(Key const &key) const {
-    return keys_[tables_.lookup(key)];
+  constexpr const_iterator find(Key const &key, std::false_type /* scan */) const {
+    // Tables return N for keys they know to be absent
+    auto const index = tables_.lookup(key);
+    if (index != N && equal_(keys_[index], key))
+      return &keys_[index];
+    else
+      return keys_.end();
+  }
+
+  constexpr const_iterator find(Key const &key, std::true_type /* scan */) const {
+    return keys_.begin() + bits::scan_find<N>(keys_.begin(), key);
   }
+
+  template <class ForwardIt, class F>
+  void lookup_many(ForwardIt first, ForwardIt last, F &&f, std::false_type /* scan */) const {
+    bits::pmh_lookup_many<N>(tables_, keys_, first, last, f);
+  }
+
+  template <class ForwardIt, class F>
+  void lookup_many(ForwardIt first, ForwardIt last, F &&f, std::true_type /* scan */) const {
+    for (; first != last; ++first)
+      f(*first, bits::scan_find<N>(keys_.begin(), *first));
+  }
+
+  constexpr unordered_set(build_type const &built, KeyEqual const &equal)
+      : equal_{equal}
+      , keys_{built.items}
+      , tables_{built.tables} {}
 };
 
 template <typename T, std::size_t N>
@@ -1,6 +1,7 @@
 #include <algorithm>
 #include <frozen/bits/algorithms.h>
 #include <iostream>
+#include <vector>
 
 #include "bench.hpp"
 #include "catch.hpp"
@@ -28,3 +29,61 @@ TEST_CASE("log", "[algorithm]") {
   REQUIRE(frozen::bits::log(16) == 4);
   REQUIRE(frozen::bits::log(32) == 5);
 }
+
+TEST_CASE("select_uint_least", "[algorithm]") {
+  static_assert(std::is_same<frozen::bits::select_uint_least_t<1>, unsigned char>::value, "");
+  static_assert(std::is_same<frozen::bits::select_uint_least_t<8>, unsigned char>::value, "");
+  static_assert(std::is_same<frozen::bits::select_uint_least_t<9>, unsigned short>::value, "");
+  static_assert(std::is_same<frozen::bits::select_uint_least_t<16>, unsigned short>::value, "");
+  static_assert(std::is_same<frozen::bits::select_uint_least_t<17>, unsigned int>::value, "");
+  static_assert(std::is_same<frozen::bits::select_uint_least_t<32>, unsigned int>::value, "");
+  static_assert(sizeof(frozen::bits::select_uint_least_t<33>) * 8 >= 33, "");
+}
+
+template <std::size_t N>
+constexpr frozen::bits::carray<int, N> scrambled(int step) {
+  frozen::bits::carray<int, N> values;
+  for (std::size_t i = 0; i < N; ++i)
+    values[i] = static_cast<int>((i * step) % 97) - 48;
+  return values;
+}
+
+template <class T, std::size_t N, class Compare>
+constexpr bool is_sorted(frozen::bits::carray<T, N> const &values, Compare const &compare) {
+  for (std::size_t i = 1; i < N; ++i)
+    if (compare(values[i], values[i - 1]))
+      return false;
+  return true;
+}
+
+TEST_CASE("sort", "[algorithm]") {
+  struct greater {
+    constexpr bool operator()(int a, int b) const { return b < a; }
+  };
+
+  // introsort, with duplicates, and radix sort of signed keys
+  static_assert(is_sorted(frozen::bits::sort(scrambled<300>(31), greater{}), greater{}), "");
+  static_assert(is_sorted(frozen::bits::sort(scrambled<300>(31), std::less<int>{}), std::less<int>{}), "");
+
+  for (int step : {0, 1, 7, 96}) {
+    auto const values = scrambled<500>(step);
+    std::vector<int> expected(values.begin(), values.end());
+    std::sort(expected.begin(), expected.end());
+
+    auto const radix = frozen::bits::sort(values, std::less<int>{});
+    REQUIRE(std::equal(radix.begin(), radix.end(), expected.begin()));
+
+    auto const introsort = frozen::bits::sort(values, greater{});
+    REQUIRE(std::equal(introsort.rbegin(), introsort.rend(), expected.begin()));
+  }
+
+  // items of a map, ordered by their keys
+  frozen::bits::carray<std::pair<long, char>, 100> items;
+  for (std::size_t i = 0; i < items.size(); ++i)
+    items[i] = {(long(i) * 37 % 100) - 50, char(i)};
+  auto const sorted = frozen::bits::sort(items, std::less<long>{});
+  for (std::size_t i = 0; i < sorted.size(); ++i) {
+    REQUIRE(sorted[i].first == long(i) - 50);
+    REQUIRE(sorted[i].second == char((i * 73) % 100));
+  }
+}
@@ -0,0 +1,33 @@
+#include <frozen/length_unordered_map.h>
+#include <frozen/string.h>
+#include <map>
+#include <string>
+
+#include "catch.hpp"
+
+TEST_CASE("frozen::length_unordered_map <> std::map", "[length_unordered_map]") {
+#define INIT_SEQ                                                               \
+  {"amp", '&'}, {"lt", '<'}, {"gt", '>'}, {"quot", '"'}, {"apos", '\''},       \
+      {"nbsp", ' '}, {"copy", 'c'}, {"reg", 'r'}, {"deg", 'd'},                \
+      {"micro", 'u'}, {"middot", '.'}, {"para", 'p'}, {"sect", 's'},          \
+      {"laquo", '<'}, {"raquo", '>'}, {"times", 'x'}, {"divide", '/'}
+
+  constexpr frozen::length_unordered_map<char, 17> frozen_map = {INIT_SEQ};
+  std::map<std::string, char> const std_map = {INIT_SEQ};
+
+  REQUIRE(std_map.size() == frozen_map.size());
+  for (auto const &kv : std_map) {
+    frozen::string const key{kv.first.data(), kv.first.size()};
+    REQUIRE(frozen_map.count(key));
+    REQUIRE(frozen_map.at(key) == kv.second);
+    REQUIRE(frozen_map.find(key)->second == kv.second);
+  }
+  for (auto const &kv : frozen_map)
+    REQUIRE(std_map.at(std::string{kv.first.data(), kv.first.size()}) == kv.second);
+
+  static_assert(frozen_map.at("quot") == '"', "constexpr lookup");
+  static_assert(!frozen_map.count("quote"), "constexpr miss");
+  REQUIRE(frozen_map.find("q") == frozen_map.end());
+  REQUIRE(frozen_map.find("mdash") == frozen_map.end());
+  REQUIRE_THROWS_AS(frozen_map.at("mdash"), std::out_of_range const &);
+}
@@ -0,0 +1,92 @@
+#include <frozen/length_unordered_set.h>
+#include <frozen/string.h>
+#include <algorithm>
+#include <set>
+#include <string>
+
+#include "catch.hpp"
+
+using namespace frozen::string_literals;
+
+TEST_CASE("tripleton frozen length unordered set", "[length_unordered_set]") {
+  constexpr frozen::length_unordered_set<3> ze_set{"one", "two", "three"};
+
+  constexpr auto empty = ze_set.empty();
+  REQUIRE(!empty);
+
+  constexpr auto size = ze_set.size();
+  REQUIRE(size == 3);
+
+  constexpr auto nocount = ze_set.count("four");
+  REQUIRE(nocount == 0);
+
+  constexpr auto count = ze_set.count("three");
+  REQUIRE(count == 1);
+
+  REQUIRE(ze_set.find("four") == ze_set.end());
+  REQUIRE(ze_set.find("tree") == ze_set.end());
+  REQUIRE(ze_set.find("two") != ze_set.end());
+
+  auto range = ze_set.equal_range("one");
+  REQUIRE(std::get<0>(range) != ze_set.end());
+  REQUIRE(*std::get<0>(range) == "one");
+
+  // keys are visited by increasing length
+  REQUIRE(std::is_sorted(ze_set.begin(), ze_set.end(),
+                         [](frozen::string a, frozen::string b) { return a.size() < b.size(); }));
+}
+
+TEST_CASE("frozen::length_unordered_set <> std::set", "[length_unordered_set]") {
+#define INIT_SEQ                                                               \
+  "", "a", "b", "ab", "ba", "abc", "bca", "cab", "abcd", "bcda", "cdab",       \
+      "dabc", "abcde", "bcdea", "cdeab", "deabc", "eabcd", "aaaaaaaa",         \
+      "aaaaaaab", "aaaaaaaaa", "baaaaaaaa", "a very long key, longer than one" \
+      " cache line, as some URLs are: https://example.com/index.html",         \
+      "another very long key, longer than one cache line and than the first"
+
+  constexpr frozen::length_unordered_set<23> frozen_set = {INIT_SEQ};
+  std::set<std::string> const std_set = {INIT_SEQ};
+
+  REQUIRE(std_set.size() == frozen_set.size());
+  for (auto const &v : std_set)
+    REQUIRE(frozen_set.count(frozen::string{v.data(), v.size()}));
+  for (auto v : frozen_set)
+    REQUIRE(std_set.count(std::string{v.data(), v.size()}));
+
+  static_assert(frozen_set.count("bcdea"), "found through the perfect hash");
+  static_assert(!frozen_set.count("bcdee"), "rejected through the perfect hash");
+  static_assert(!frozen_set.count("abcdef"), "no key of that length");
+
+  REQUIRE(!frozen_set.count("aaaaaaac"));
+  REQUIRE(!frozen_set.count("caaaaaaaa"));
+  REQUIRE(!frozen_set.count("a very long key, longer than one cache line, as some URLs are"));
+  REQUIRE(!frozen_set.count("a"
+                            " very long key, longer than one cache line, as some URLs are: "
+                            "https://example.com/index.htm!"));
+
+  constexpr auto made = frozen::make_length_unordered_set({"x"_s, "yy"_s});
+  REQUIRE(made.count("yy"));
+}
+
+namespace {
+// Keys shorter than five bytes hash alike whatever the seed
+struct short_colliding_hash {
+  constexpr std::size_t operator()(frozen::string value, std::size_t seed) const {
+    return value.size() < 5 ? seed : frozen::elsa<frozen::string>{}(value, seed);
+  }
+};
+}
+
+TEST_CASE("frozen::length_unordered_set only hashes large classes", "[length_unordered_set]") {
+  // no class is hashed, so no perfect hash function is built
+  constexpr frozen::length_unordered_set<4, short_colliding_hash> scanned = {"a", "bb", "cc", "dddd"};
+  static_assert(scanned.count("cc") && !scanned.count("ee"), "");
+
+  // only the five keys of five bytes are hashed
+  constexpr frozen::length_unordered_set<11, short_colliding_hash> mixed = {
+      "a", "b", "ab", "ba", "abc", "abcde", "bcdea", "cdeab", "deabc", "eabcd", "abcdef"};
+  static_assert(mixed.count("cdeab") && !mixed.count("edcba"), "found through the perfect hash");
+  static_assert(mixed.count("ba") && !mixed.count("bb"), "scanned");
+  REQUIRE(std::is_sorted(mixed.begin(), mixed.end(),
+                         [](frozen::string a, frozen::string b) { return a.size() < b.size(); }));
+}
@@ -1,7 +1,10 @@
 #include <algorithm>
+#include <cstdint>
 #include <frozen/map.h>
 #include <iostream>
+#include <limits>
 #include <map>
+#include <vector>
 
 #include "bench.hpp"
 #include "catch.hpp"
@@ -295,3 +298,186 @@ TEST_CASE("frozen::map constexpr", "[map]") {
   static_assert(!ce.count(0), "");
   static_assert(ce.find(0) == ce.end(), "");
 }
+
+TEST_CASE("frozen::map batched lookups", "[map]") {
+  constexpr frozen::map<int, int, 128> frozen_map = {INIT_SEQ};
+  std::vector<int> queries;
+  for (auto const &kv : frozen_map)
+    queries.push_back(kv.first);
+  for (int v = -40; v < 4; ++v)
+    queries.push_back(v);
+
+  std::vector<decltype(frozen_map)::const_iterator> found(queries.size());
+  std::vector<std::size_t> counts(queries.size());
+  REQUIRE(frozen_map.find_many(queries.begin(), queries.end(), found.begin()) == found.end());
+  REQUIRE(frozen_map.count_many(queries.begin(), queries.end(), counts.begin()) == counts.end());
+  for (std::size_t i = 0; i < queries.size(); ++i) {
+    REQUIRE(found[i] == frozen_map.find(queries[i]));
+    REQUIRE(counts[i] == frozen_map.count(queries[i]));
+  }
+}
+
+TEST_CASE("frozen::map sorted batched lookups", "[map]") {
+  constexpr frozen::map<int, int, 128> frozen_map = {INIT_SEQ};
+  std::vector<int> queries;
+  for (auto const &kv : frozen_map) {
+    queries.push_back(kv.first - 1);
+    queries.push_back(kv.first);
+    queries.push_back(kv.first);
+  }
+  queries.push_back(std::numeric_limits<int>::max());
+
+  std::vector<decltype(frozen_map)::const_iterator> found(queries.size());
+  std::vector<std::size_t> counts(queries.size());
+  REQUIRE(frozen_map.find_sorted(queries.begin(), queries.end(), found.begin()) == found.end());
+  REQUIRE(frozen_map.count_sorted(queries.begin(), queries.end(), counts.begin()) == counts.end());
+  for (std::size_t i = 0; i < queries.size(); ++i) {
+    REQUIRE(found[i] == frozen_map.find(queries[i]));
+    REQUIRE(counts[i] == frozen_map.count(queries[i]));
+  }
+}
+
+TEST_CASE("frozen::map with dense keys", "[map]") {
+  enum class color { red, green, blue, cyan, magenta = 6, yellow, black = 12 };
+
+  SECTION("without holes") {
+    constexpr frozen::map<char, int, 5> digits = {{'4', 4}, {'0', 0}, {'2', 2}, {'1', 1}, {'3', 3}};
+    static_assert(digits.at('3') == 3, "");
+    static_assert(digits.count('5') == 0, "");
+    static_assert(digits.find('/') == digits.end(), "");
+    for (char c = 0; c < 127; ++c)
+      REQUIRE(digits.count(c) == (c >= '0' && c <= '4'));
+    REQUIRE(digits.upper_bound('2')->first == '3');
+  }
+
+  SECTION("with holes") {
+    constexpr frozen::map<color, int, 7> colors = {
+        {color::red, 0},     {color::green, 1},  {color::blue, 2},  {color::cyan, 3},
+        {color::magenta, 6}, {color::yellow, 7}, {color::black, 12}};
+    for (int i = -2; i < 16; ++i) {
+      auto const where = colors.find(static_cast<color>(i));
+      if ((i >= 0 && i < 4) || i == 6 || i == 7 || i == 12)
+        REQUIRE(where->second == i);
+      else
+        REQUIRE(where == colors.end());
+    }
+    REQUIRE_THROWS_AS(colors.at(static_cast<color>(5)), std::out_of_range const &);
+  }
+
+  SECTION("with duplicates") {
+    constexpr frozen::map<int, int, 3> twice = {{1, 10}, {1, 11}, {3, 30}};
+    static_assert(twice.count(2) == 0, "");
+    static_assert(twice.at(3) == 30, "");
+    REQUIRE(twice.count(1) == 1);
+    REQUIRE(twice.find(0) == twice.end());
+  }
+
+  SECTION("negative keys") {
+    constexpr frozen::map<int, int, 6> offsets = {{-3, 0}, {-2, 1}, {-1, 2}, {1, 4}, {2, 5}, {4, 7}};
+    static_assert(offsets.at(-1) == 2, "");
+    static_assert(offsets.count(0) == 0, "");
+    for (int i = -8; i < 8; ++i)
+      REQUIRE(offsets.count(i) == (i >= -3 && i != 0 && i != 3 && i <= 4));
+    REQUIRE(offsets.find(std::numeric_limits<int>::min()) == offsets.end());
+    REQUIRE(offsets.find(std::numeric_limits<int>::max()) == offsets.end());
+  }
+
+  SECTION("sparse keys") {
+    constexpr frozen::map<unsigned long, int, 3> sparse = {{1, 0}, {100, 1}, {~0ul, 2}};
+    static_assert(sparse.at(100) == 1, "");
+    REQUIRE(sparse.at(~0ul) == 2);
+    REQUIRE(sparse.count(2) == 0);
+  }
+}
+
+template <class Layout>
+static void check_layout_map() {
+  constexpr std::size_t size = 300;
+  frozen::bits::carray<std::pair<int, int>, size> items;
+  std::map<int, int> std_map;
+  for (int i = 0; i < int(size); ++i) {
+    items[i] = {3 * ((i * 7) % int(size)) - 100, i};
+    std_map.insert(items[i]);
+  }
+  frozen::map<int, int, size, std::less<int>, Layout> const frozen_map(items);
+
+  REQUIRE(std::equal(std_map.begin(), std_map.end(), frozen_map.begin(), frozen_map.end(),
+                     [](std::pair<const int, int> const &a, std::pair<int, int> const &b) {
+                       return a.first == b.first && a.second == b.second;
+                     }));
+  REQUIRE(frozen_map.rbegin()->first == std_map.rbegin()->first);
+  for (int v = -110; v < 3 * int(size); ++v) {
+    auto const where = std_map.find(v);
+    if (where == std_map.end()) {
+      REQUIRE(frozen_map.find(v) == frozen_map.end());
+      REQUIRE_THROWS_AS(frozen_map.at(v), std::out_of_range const &);
+    } else {
+      REQUIRE(frozen_map.find(v) - frozen_map.begin() == std::distance(std_map.begin(), where));
+      REQUIRE(frozen_map.at(v) == where->second);
+    }
+  }
+}
+
+TEST_CASE("frozen::map with eytzinger layout", "[map]") {
+  check_layout_map<frozen::eytzinger_layout>();
+
+  constexpr frozen::map<int, int, 4, std::less<int>, frozen::eytzinger_layout> small = {
+      {4, 40}, {1, 10}, {3, 30}, {2, 20}};
+  static_assert(small.at(3) == 30, "");
+  static_assert(small.count(5) == 0, "");
+  static_assert(small.begin()->second == 10, "");
+}
+
+TEST_CASE("frozen::map with stree layout", "[map]") {
+  check_layout_map<frozen::stree_layout>();
+
+  constexpr frozen::map<std::uint64_t, char, 20, std::less<std::uint64_t>, frozen::stree_layout> letters = {
+      {~0ull, 'a'}, {1, 'b'},  {2, 'c'},  {3, 'd'},  {4, 'e'},  {5, 'f'},  {6, 'g'},
+      {7, 'h'},     {8, 'i'},  {9, 'j'},  {10, 'k'}, {11, 'l'}, {12, 'm'}, {13, 'n'},
+      {14, 'o'},    {15, 'p'}, {16, 'q'}, {17, 'r'}, {18, 's'}, {1ull << 63, 't'}};
+  static_assert(letters.at(~0ull) == 'a', "");
+  static_assert(letters.at(1ull << 63) == 't', "");
+  static_assert(letters.count(0) == 0, "");
+  REQUIRE(letters.at(~0ull) == 'a');
+  REQUIRE(letters.at(1ull << 63) == 't');
+  REQUIRE(letters.at(17) == 'r');
+  REQUIRE(letters.count((1ull << 63) + 1) == 0);
+  REQUIRE(letters.rbegin()->second == 'a');
+}
+
+TEST_CASE("frozen::map with learned layout", "[map]") {
+  check_layout_map<frozen::learned_layout>();
+
+  constexpr frozen::map<std::uint64_t, char, 5, std::less<std::uint64_t>, frozen::learned_layout> letters = {
+      {~0ull, 'a'}, {1, 'b'}, {2, 'c'}, {1ull << 40, 'd'}, {1ull << 63, 'e'}};
+  static_assert(letters.at(~0ull) == 'a', "");
+  static_assert(letters.at(1ull << 40) == 'd', "");
+  static_assert(letters.count(0) == 0, "");
+  REQUIRE(letters.at(2) == 'c');
+  REQUIRE(letters.count((1ull << 63) + 1) == 0);
+  REQUIRE(letters.rbegin()->second == 'a');
+}
+
+TEST_CASE("frozen::map with soa layout", "[map]") {
+  check_layout_map<frozen::soa_layout>();
+
+  constexpr frozen::map<int, char, 4, std::less<int>, frozen::soa_layout> letters = {
+      {4, 'd'}, {1, 'a'}, {3, 'c'}, {2, 'b'}};
+  static_assert(letters.at(3) == 'c', "");
+  static_assert(letters.count(5) == 0, "");
+  static_assert(letters.begin()->second == 'a', "");
+  static_assert((*(letters.end() - 1)).first == 4, "");
+  REQUIRE(letters.rbegin()->second == 'd');
+  REQUIRE(letters.lower_bound(2)->second == 'b');
+  REQUIRE(letters.upper_bound(2)->second == 'c');
+
+  std::vector<std::pair<int, char>> const items(letters.begin(), letters.end());
+  REQUIRE((items == std::vector<std::pair<int, char>>{{1, 'a'}, {2, 'b'}, {3, 'c'}, {4, 'd'}}));
+
+  std::vector<int> queries = {0, 1, 2, 5};
+  std::vector<std::size_t> counts(queries.size());
+  letters.count_many(queries.begin(), queries.end(), counts.begin());
+  REQUIRE((counts == std::vector<std::size_t>{0, 1, 1, 0}));
+  letters.count_sorted(queries.begin(), queries.end(), counts.begin());
+  REQUIRE((counts == std::vector<std::size_t>{0, 1, 1, 0}));
+}
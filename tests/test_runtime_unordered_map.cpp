@@ -0,0 +1,78 @@
+#include <frozen/runtime_unordered_map.h>
+#include <frozen/string.h>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "bench.hpp"
+#include "catch.hpp"
+
+TEST_CASE("empty frozen runtime unordered map", "[runtime_unordered_map]") {
+  frozen::runtime_unordered_map<int, int> ze_map{std::vector<std::pair<int, int>>{}};
+
+  REQUIRE(ze_map.empty());
+  REQUIRE(ze_map.size() == 0);
+  REQUIRE(ze_map.count(1) == 0);
+  REQUIRE(ze_map.find(1) == ze_map.end());
+  REQUIRE(ze_map.begin() == ze_map.end());
+}
+
+TEST_CASE("frozen::runtime_unordered_map <> std::unordered_map", "[runtime_unordered_map]") {
+  std::vector<std::pair<unsigned, unsigned>> items;
+  for (unsigned i = 0; i < 100000; ++i)
+    items.emplace_back(i * 7919u, i);
+
+  const std::unordered_map<unsigned, unsigned> std_map(items.begin(), items.end());
+  const frozen::runtime_unordered_map<unsigned, unsigned> frozen_map(items.begin(), items.end());
+
+  REQUIRE(std_map.size() == frozen_map.size());
+  for (auto v : std_map)
+    REQUIRE(frozen_map.at(v.first) == v.second);
+  for (auto v : frozen_map)
+    REQUIRE(std_map.at(v.first) == v.second);
+  for (unsigned i = 1; i < 1000; ++i)
+    REQUIRE(frozen_map.count(i * 7919u + 1) == 0);
+
+  // a few bits per key
+  REQUIRE(frozen_map.function_bit_size() < 4 * frozen_map.size());
+}
+
+TEST_CASE("frozen::runtime_unordered_map with string keys", "[runtime_unordered_map]") {
+  std::vector<std::string> storage;
+  for (int i = 0; i < 1000; ++i)
+    storage.push_back("key" + std::to_string(i));
+
+  std::vector<std::pair<frozen::string, int>> items;
+  for (int i = 0; i < 1000; ++i)
+    items.emplace_back(frozen::string{storage[i].data(), storage[i].size()}, i);
+
+  const frozen::runtime_unordered_map<frozen::string, int> frozen_map(items);
+  for (int i = 0; i < 1000; ++i) {
+    auto where = frozen_map.find(frozen::string{storage[i].data(), storage[i].size()});
+    REQUIRE(where != frozen_map.end());
+    REQUIRE(where->second == i);
+  }
+  REQUIRE(frozen_map.count("key") == 0);
+  REQUIRE(frozen_map.count("key1000") == 0);
+
+  auto range = frozen_map.equal_range("key12");
+  REQUIRE(std::distance(range.first, range.second) == 1);
+  REQUIRE(range.first->second == 12);
+}
+
+TEST_CASE("frozen::runtime_unordered_map rejects duplicate keys", "[runtime_unordered_map]") {
+  REQUIRE_THROWS_AS((frozen::runtime_unordered_map<int, int>{{1, 1}, {2, 2}, {1, 3}}),
+                    std::invalid_argument const &);
+}
+
+namespace {
+// Distinct keys, same hash whatever the seed
+struct colliding_hash {
+  std::size_t operator()(int, std::size_t seed) const { return seed; }
+};
+}
+
+TEST_CASE("frozen::runtime_unordered_map gives up on colliding keys", "[runtime_unordered_map]") {
+  REQUIRE_THROWS_AS((frozen::runtime_unordered_map<int, int, colliding_hash>{{1, 1}, {2, 2}}),
+                    std::runtime_error const &);
+}
@@ -1,7 +1,13 @@
 #include <algorithm>
+#include <climits>
+#include <cstdint>
 #include <frozen/set.h>
 #include <iostream>
+#include <limits>
+#include <numeric>
+#include <random>
 #include <set>
+#include <vector>
 
 #include "bench.hpp"
 #include "catch.hpp"
@@ -275,3 +281,258 @@ TEST_CASE("frozen::set of frozen::set", "[set]") {
   static_assert(!ce.count(s1({0})), "");
   static_assert(ce.find(s1({0})) == ce.end(), "");
 }
+
+TEST_CASE("frozen::set batched lookups", "[set]") {
+  constexpr frozen::set<int, 128> frozen_set = {INIT_SEQ};
+  std::vector<int> queries = {INIT_SEQ};
+  for (int v = -40; v < 4; ++v)
+    queries.push_back(v);
+
+  std::vector<decltype(frozen_set)::const_iterator> found(queries.size());
+  std::vector<std::size_t> counts(queries.size());
+  REQUIRE(frozen_set.find_many(queries.begin(), queries.end(), found.begin()) == found.end());
+  REQUIRE(frozen_set.count_many(queries.begin(), queries.end(), counts.begin()) == counts.end());
+  for (std::size_t i = 0; i < queries.size(); ++i) {
+    REQUIRE(found[i] == frozen_set.find(queries[i]));
+    REQUIRE(counts[i] == frozen_set.count(queries[i]));
+  }
+
+  constexpr frozen::set<int, 0> empty_set = {};
+  REQUIRE(empty_set.count_many(queries.begin(), queries.end(), counts.begin()) == counts.end());
+  REQUIRE(counts[0] == 0);
+}
+
+template <class Layout>
+static void check_sorted_lookups() {
+  constexpr frozen::set<int, 128> reference = {INIT_SEQ};
+  frozen::set<int, 128, std::less<int>, Layout> const frozen_set = {INIT_SEQ};
+  std::vector<int> queries = {INIT_SEQ};
+  for (int v = -40; v < 4; ++v)
+    queries.push_back(v);
+  queries.push_back(1118779989);
+  std::sort(queries.begin(), queries.end());
+  // out of order keys restart the search
+  queries.push_back(2);
+  queries.push_back(1);
+
+  std::vector<typename decltype(frozen_set)::const_iterator> found(queries.size());
+  std::vector<std::size_t> counts(queries.size());
+  REQUIRE(frozen_set.find_sorted(queries.begin(), queries.end(), found.begin()) == found.end());
+  REQUIRE(frozen_set.count_sorted(queries.begin(), queries.end(), counts.begin()) == counts.end());
+  for (std::size_t i = 0; i < queries.size(); ++i) {
+    REQUIRE(found[i] == frozen_set.find(queries[i]));
+    REQUIRE(counts[i] == reference.count(queries[i]));
+  }
+}
+
+TEST_CASE("frozen::set sorted batched lookups", "[set]") {
+  check_sorted_lookups<frozen::sorted_layout>();
+  check_sorted_lookups<frozen::eytzinger_layout>();
+  check_sorted_lookups<frozen::stree_layout>();
+
+  std::vector<int> queries = {1, 2, 3};
+  std::vector<std::size_t> counts(queries.size());
+  constexpr frozen::set<int, 0> empty_set = {};
+  REQUIRE(empty_set.count_sorted(queries.begin(), queries.end(), counts.begin()) == counts.end());
+  REQUIRE(counts[0] == 0);
+
+  constexpr frozen::set<int, 1> single = {2};
+  single.count_sorted(queries.begin(), queries.end(), counts.begin());
+  REQUIRE((counts == std::vector<std::size_t>{0, 1, 0}));
+}
+
+TEST_CASE("frozen::set with dense keys", "[set]") {
+  constexpr frozen::set<short, 8> dense = {-4, -3, -1, 0, 1, 2, 3, 5};
+  static_assert(dense.count(-1), "");
+  static_assert(!dense.count(-2), "");
+  for (int i = -10; i < 10; ++i) {
+    auto const where = dense.find(static_cast<short>(i));
+    if (i >= -4 && i <= 5 && i != -2 && i != 4)
+      REQUIRE(*where == i);
+    else
+      REQUIRE(where == dense.end());
+  }
+
+  constexpr frozen::set<bool, 2> booleans = {true, false};
+  static_assert(booleans.count(true) && booleans.count(false), "");
+  static_assert(*booleans.find(true), "");
+
+  constexpr frozen::set<unsigned char, 1> singleton = {7};
+  static_assert(singleton.count(7) && !singleton.count(6) && !singleton.count(8), "");
+
+  // duplicate keys are not dense, whatever their span
+  constexpr frozen::set<int, 3> twice = {1, 1, 3};
+  static_assert(!twice.count(2) && twice.count(1) && twice.count(3), "");
+  constexpr frozen::set<int, 4> shifted = {1, 1, 2, 4};
+  static_assert(shifted.count(2) && shifted.count(4) && !shifted.count(3), "");
+}
+
+template <class Layout, std::size_t N>
+static void check_layout_set() {
+  frozen::bits::carray<unsigned, N> keys;
+  for (unsigned i = 0; i < N; ++i)
+    keys[i] = 3 * ((i * 7) % N) + 1;
+  frozen::set<unsigned, N> const sorted(keys);
+  frozen::set<unsigned, N, std::less<unsigned>, Layout> const laid_out(keys);
+
+  REQUIRE(std::equal(sorted.begin(), sorted.end(), laid_out.begin(), laid_out.end()));
+  REQUIRE(std::equal(sorted.rbegin(), sorted.rend(), laid_out.rbegin(), laid_out.rend()));
+  for (unsigned v = 0; v < 3 * N + 3; ++v) {
+    REQUIRE(laid_out.count(v) == sorted.count(v));
+    REQUIRE(laid_out.find(v) - laid_out.begin() == sorted.find(v) - sorted.begin());
+    REQUIRE(laid_out.upper_bound(v) - laid_out.begin() == sorted.upper_bound(v) - sorted.begin());
+  }
+
+  std::vector<unsigned> queries(3 * N + 3);
+  std::iota(queries.begin(), queries.end(), 0u);
+  std::vector<std::size_t> counts(queries.size());
+  laid_out.count_many(queries.begin(), queries.end(), counts.begin());
+  for (std::size_t i = 0; i < queries.size(); ++i)
+    REQUIRE(counts[i] == sorted.count(queries[i]));
+}
+
+TEST_CASE("frozen::set with eytzinger layout", "[set]") {
+  check_layout_set<frozen::eytzinger_layout, 1>();
+  check_layout_set<frozen::eytzinger_layout, 2>();
+  check_layout_set<frozen::eytzinger_layout, 3>();
+  check_layout_set<frozen::eytzinger_layout, 7>();
+  check_layout_set<frozen::eytzinger_layout, 8>();
+  check_layout_set<frozen::eytzinger_layout, 100>();
+
+  constexpr frozen::set<int, 128, std::less<int>, frozen::eytzinger_layout> frozen_set = {INIT_SEQ};
+  static_assert(frozen_set.count(1115779988), "");
+  static_assert(!frozen_set.count(3), "");
+  static_assert(*frozen_set.begin() == 1, "");
+  static_assert(*(frozen_set.end() - 1) == 1118779988, "");
+  REQUIRE(std::is_sorted(frozen_set.begin(), frozen_set.end()));
+}
+
+TEST_CASE("frozen::set with stree layout", "[set]") {
+  check_layout_set<frozen::stree_layout, 1>();
+  check_layout_set<frozen::stree_layout, 16>();
+  check_layout_set<frozen::stree_layout, 17>();
+  check_layout_set<frozen::stree_layout, 300>();
+  check_layout_set<frozen::stree_layout, 1000>();
+
+  constexpr frozen::set<int, 128, std::less<int>, frozen::stree_layout> frozen_set = {INIT_SEQ};
+  static_assert(frozen_set.count(1115779988), "");
+  static_assert(!frozen_set.count(3), "");
+  static_assert(*frozen_set.begin() == 1, "");
+  static_assert(*(frozen_set.end() - 1) == 1118779988, "");
+  REQUIRE(std::is_sorted(frozen_set.begin(), frozen_set.end()));
+  for (int v : {INT_MIN, -1, 0, 3, 1118779989, INT_MAX})
+    REQUIRE(frozen_set.find(v) == frozen_set.end());
+
+  frozen::bits::carray<std::int64_t, 40> wide;
+  for (int i = 0; i < 40; ++i)
+    wide[i] = (i - 20) * (std::int64_t(1) << 40);
+  frozen::set<std::int64_t, 40, std::less<std::int64_t>, frozen::stree_layout> const wide_set(wide);
+  for (int i = -25; i < 25; ++i) {
+    REQUIRE(wide_set.count(i * (std::int64_t(1) << 40)) == (i >= -20 && i < 20));
+    REQUIRE(wide_set.count(i * (std::int64_t(1) << 40) + 1) == 0);
+  }
+
+  constexpr frozen::set<std::pair<int, int>, 3, std::less<std::pair<int, int>>, frozen::stree_layout>
+      pairs = {{1, 2}, {1, 1}, {0, 5}};
+  static_assert(pairs.count({1, 1}) && !pairs.count({1, 3}), "");
+  static_assert(pairs.begin()->second == 5, "");
+}
+
+template <class Key, std::size_t N>
+static void check_scanned_set() {
+  frozen::bits::carray<Key, N> keys;
+  for (std::size_t i = 0; i < N; ++i)
+    keys[i] = static_cast<Key>((i * 7) % N) * 3 - 5;
+  frozen::set<Key, N> const frozen_set(keys);
+  std::set<Key> const std_set(keys.begin(), keys.end());
+
+  for (Key v = -10; v < static_cast<Key>(3 * N); ++v) {
+    REQUIRE(frozen_set.count(v) == std_set.count(v));
+    auto const where = frozen_set.find(v);
+    if (std_set.count(v))
+      REQUIRE(*where == v);
+    else
+      REQUIRE(where == frozen_set.end());
+  }
+}
+
+TEST_CASE("frozen::set of few keys", "[set]") {
+  check_scanned_set<int, 1>();
+  check_scanned_set<int, 3>();
+  check_scanned_set<int, 4>();
+  check_scanned_set<int, 9>();
+  check_scanned_set<int, 31>();
+  check_scanned_set<int, 32>();
+  check_scanned_set<int64_t, 1>();
+  check_scanned_set<int64_t, 5>();
+  check_scanned_set<int64_t, 16>();
+
+  constexpr frozen::set<unsigned, 5> frozen_set = {UINT_MAX, 0, 1u << 31, 7, 100};
+  static_assert(frozen_set.count(UINT_MAX), "");
+  static_assert(frozen_set.find(7) == frozen_set.begin() + 1, "");
+  static_assert(!frozen_set.count(8), "");
+  REQUIRE(frozen_set.count(1u << 31));
+  REQUIRE(frozen_set.find(100) == frozen_set.begin() + 2);
+  REQUIRE(frozen_set.find(8) == frozen_set.end());
+  REQUIRE(frozen_set.upper_bound(7) == frozen_set.begin() + 2);
+}
+
+template <class Key, std::size_t N>
+static void check_learned_set(frozen::bits::carray<Key, N> const &keys) {
+  frozen::set<Key, N, std::less<Key>, frozen::learned_layout> const frozen_set(keys);
+  std::set<Key> const std_set(keys.begin(), keys.end());
+
+  REQUIRE(std::equal(std_set.begin(), std_set.end(), frozen_set.begin(), frozen_set.end()));
+  for (auto key : keys) {
+    for (Key v : {Key(key - 1), key, Key(key + 1)}) {
+      REQUIRE(frozen_set.count(v) == std_set.count(v));
+      REQUIRE(frozen_set.upper_bound(v) - frozen_set.begin() ==
+              (std_set.count(v) ? std::distance(std_set.begin(), std_set.upper_bound(v)) : std::ptrdiff_t(N)));
+    }
+  }
+  REQUIRE(frozen_set.count(std::numeric_limits<Key>::min()) == std_set.count(std::numeric_limits<Key>::min()));
+  REQUIRE(frozen_set.count(std::numeric_limits<Key>::max()) == std_set.count(std::numeric_limits<Key>::max()));
+}
+
+TEST_CASE("frozen::set with learned layout", "[set]") {
+  check_layout_set<frozen::learned_layout, 1>();
+  check_layout_set<frozen::learned_layout, 2>();
+  check_layout_set<frozen::learned_layout, 33>();
+  check_layout_set<frozen::learned_layout, 300>();
+  check_layout_set<frozen::learned_layout, 1000>();
+
+  // skewed keys: cubes, and two distant clusters
+  frozen::bits::carray<std::uint64_t, 500> cubes;
+  for (std::uint64_t i = 0; i < 500; ++i)
+    cubes[i] = 5 * i * i * i;
+  check_learned_set(cubes);
+
+  frozen::bits::carray<std::int64_t, 200> clusters;
+  for (std::int64_t i = 0; i < 200; ++i)
+    clusters[i] = i < 150 ? -(std::int64_t(1) << 60) + 7 * i : (std::int64_t(1) << 50) + 3 * i;
+  check_learned_set(clusters);
+
+  // uniform keys leave some leaves without items; probe absent keys too
+  std::mt19937 gen(1024);
+  std::set<std::uint32_t> drawn;
+  while (drawn.size() < 1024)
+    drawn.insert(gen() & 0xffffff);
+  frozen::bits::carray<std::uint32_t, 1024> uniform;
+  std::copy(drawn.begin(), drawn.end(), uniform.begin());
+  check_learned_set(uniform);
+  frozen::set<std::uint32_t, 1024, std::less<std::uint32_t>, frozen::learned_layout> const uniform_set(uniform);
+  for (int i = 0; i < 100000; ++i) {
+    std::uint32_t const v = gen() & 0x1ffffff;
+    REQUIRE(uniform_set.count(v) == std::binary_search(uniform.begin(), uniform.end(), v));
+    auto const where = uniform_set.find(v);
+    REQUIRE((where == uniform_set.end() || *where == v));
+  }
+
+  constexpr frozen::set<int, 128, std::less<int>, frozen::learned_layout> frozen_set = {INIT_SEQ};
+  static_assert(frozen_set.count(1115779988), "");
+  static_assert(!frozen_set.count(3), "");
+  static_assert(*frozen_set.begin() == 1, "");
+  REQUIRE(std::is_sorted(frozen_set.begin(), frozen_set.end()));
+  for (int v : {INT_MIN, -1, 0, 3, 1118779989, INT_MAX})
+    REQUIRE(frozen_set.find(v) == frozen_set.end());
+}
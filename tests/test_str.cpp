@@ -1,5 +1,7 @@
+#include <frozen/crc_hash.h>
 #include <frozen/string.h>
 #include <frozen/algorithm.h>
+#include <frozen/unordered_set.h>
 #include <string>
 #include <iostream>
 
@@ -84,3 +86,72 @@ TEST_CASE("Boyer-Moore str search", "[str-search]") {
 
 }
 
+
+namespace {
+
+constexpr char lyrics[] = "The cold never bothered me anyway \xc3\xa9\xff !";
+constexpr std::size_t lyrics_size = sizeof(lyrics) - 1;
+
+struct lyrics_hashes {
+  std::size_t prefixes[lyrics_size + 1];
+  std::size_t suffixes[lyrics_size + 1];
+};
+
+template <class Hash = frozen::elsa<frozen::string>>
+constexpr lyrics_hashes hash_lyrics(std::size_t seed) {
+  lyrics_hashes hashes{};
+  for (std::size_t n = 0; n <= lyrics_size; ++n) {
+    hashes.prefixes[n] = Hash{}({lyrics, n}, seed);
+    hashes.suffixes[n] = Hash{}({lyrics + n, lyrics_size - n}, seed);
+  }
+  return hashes;
+}
+
+} // namespace
+
+TEST_CASE("String hash", "[string]") {
+  constexpr auto hashes = hash_lyrics(42);
+  static_assert(hashes.prefixes[7] != hashes.prefixes[8], "frozen::string constexpr hash");
+
+  // Tables built at compile time are used at runtime, so both must agree
+  std::size_t volatile seed = 42;
+  for (std::size_t n = 0; n <= lyrics_size; ++n) {
+    REQUIRE(frozen::elsa<frozen::string>{}({lyrics, n}, seed) == hashes.prefixes[n]);
+    REQUIRE(frozen::elsa<frozen::string>{}({lyrics + n, lyrics_size - n}, seed) == hashes.suffixes[n]);
+  }
+
+  REQUIRE(std::hash<frozen::string>{}("Let it go") == frozen::elsa<frozen::string>{}("Let it go"));
+  REQUIRE(frozen::elsa<frozen::string>{}("Let it go", 0) != frozen::elsa<frozen::string>{}("Let it go", 1));
+}
+
+TEST_CASE("CRC hash", "[string]") {
+  // RFC 3720, B.4: CRC32C of 32 zero bytes
+  constexpr auto zeros = ~frozen::bits::crc32c_word(
+      frozen::bits::crc32c_word(frozen::bits::crc32c_word(frozen::bits::crc32c_word(~0u, 0), 0), 0), 0);
+  static_assert(zeros == 0x8a9136aau, "CRC32C");
+
+  constexpr auto hashes = hash_lyrics<frozen::crc_hash<frozen::string>>(42);
+  std::size_t volatile seed = 42;
+  for (std::size_t n = 0; n <= lyrics_size; ++n) {
+    REQUIRE(frozen::crc_hash<frozen::string>{}({lyrics, n}, seed) == hashes.prefixes[n]);
+    REQUIRE(frozen::crc_hash<frozen::string>{}({lyrics + n, lyrics_size - n}, seed) == hashes.suffixes[n]);
+  }
+
+  constexpr auto hashed = frozen::crc_hash<int>{}(-1, 42);
+  REQUIRE(frozen::crc_hash<int>{}(-1, seed) == hashed);
+  REQUIRE(frozen::crc_hash<int>{}(1, 0) != frozen::crc_hash<int>{}(1, 1));
+
+  // words (0, d) and (d, 0) have the same CRC32C and the same sum
+  static constexpr char swapped[2][16] = {
+      {0, 0, 0, 0, 0, 0, 0, 0, '\xaf', '\x2d', '\xa4', '\xfc', 0, 0, 0, 0},
+      {'\xaf', '\x2d', '\xa4', '\xfc', 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0}};
+  constexpr frozen::string first{swapped[0], 16}, second{swapped[1], 16};
+  static_assert(frozen::bits::crc32c_word(frozen::bits::crc32c_word(0, 0), 0xfca42dafu) ==
+                    frozen::bits::crc32c_word(frozen::bits::crc32c_word(0, 0xfca42dafu), 0),
+                "CRC collision");
+  static_assert(frozen::crc_hash<frozen::string>{}(first, 1) != frozen::crc_hash<frozen::string>{}(second, 1), "");
+  REQUIRE(frozen::crc_hash<frozen::string>{}(first, seed) != frozen::crc_hash<frozen::string>{}(second, seed));
+  constexpr frozen::unordered_set<frozen::string, 2, frozen::crc_hash<frozen::string>> both = {first, second};
+  REQUIRE(both.count(first));
+  REQUIRE(both.count(second));
+}
@@ -41,6 +41,9 @@ TEST_CASE("tripleton int frozen ordered set", "[set]") {
   REQUIRE(cbegin != cend);
 
   std::for_each(ze_set.begin(), ze_set.end(), [](frozen::string const &) {});
+
+  // string keys are not dense searchable, and the set stores no hole count
+  static_assert(sizeof(ze_set) <= sizeof(frozen::bits::carray<frozen::string, 3>) + sizeof(void *), "");
 }
 
 TEST_CASE("frozen::set<str> <> std::set",
@@ -1,6 +1,11 @@
+#include <frozen/string.h>
 #include <frozen/unordered_map.h>
+#include <frozen/unordered_set.h>
+#include <array>
 #include <iostream>
+#include <tuple>
 #include <unordered_map>
+#include <vector>
 
 #include "bench.hpp"
 #include "catch.hpp"
@@ -134,6 +139,127 @@ TEST_CASE("frozen::unordered_map <> std::unordered_map", "[unordered_map]") {
                              typename decltype(frozen_map)::mapped_type>::value, "");
 }
 
+TEST_CASE("frozen::unordered_map with minimal storage", "[unordered_map]") {
+  const std::unordered_map<int, int> std_map = { INIT_SEQ };
+  constexpr frozen::unordered_map<int, int, 128, frozen::elsa<int>, std::equal_to<int>,
+                                  frozen::minimal_pmh> frozen_map = { INIT_SEQ };
+  static_assert(frozen_map.bucket_count() == 128, "");
+
+  REQUIRE(std_map.size() == frozen_map.size());
+  for (auto v : std_map)
+    REQUIRE(frozen_map.at(v.first) == v.second);
+  for (auto v : frozen_map)
+    REQUIRE(std_map.count(v.first));
+  REQUIRE(frozen_map.count(3) == 0);
+
+  // keys stay in initialization order
+  REQUIRE(frozen_map.begin()->first == 19);
+
+  constexpr frozen::unordered_map<int, int, 5, frozen::elsa<int>, std::equal_to<int>,
+                                  frozen::basic_hanov_pmh<frozen::pmh_load_factor<80>>>
+      small_map = {{1, 1}, {2, 2}, {3, 3}, {4, 4}, {5, 5}};
+  static_assert(small_map.bucket_count() == 7, "");
+  static_assert(small_map.at(4) == 4, "");
+  static_assert(small_map.count(6) == 0, "");
+}
+
+TEST_CASE("frozen::unordered_map with slot ordered storage", "[unordered_map]") {
+  const std::unordered_map<int, int> std_map = { INIT_SEQ };
+  constexpr frozen::unordered_map<int, int, 128, frozen::elsa<int>, std::equal_to<int>,
+                                  frozen::slot_ordered_pmh> frozen_map = { INIT_SEQ };
+
+  REQUIRE(std_map.size() == frozen_map.size());
+  for (auto v : std_map)
+    REQUIRE(frozen_map.at(v.first) == v.second);
+  for (auto v : frozen_map)
+    REQUIRE(std_map.count(v.first));
+  for (int v = -64; v < 0; ++v)
+    REQUIRE(frozen_map.find(v) == frozen_map.end());
+
+  // no second table
+  REQUIRE(sizeof(frozen_map) <= 128 * sizeof(std::pair<int, int>) + frozen_map.bucket_count() * 2 + 32);
+
+  constexpr frozen::unordered_map<int, int, 5, frozen::elsa<int>, std::equal_to<int>,
+                                  frozen::basic_slot_ordered_pmh<frozen::pmh_minimal_storage>>
+      small_map = {{1, 1}, {2, 2}, {3, 3}, {4, 4}, {5, 5}};
+  static_assert(small_map.at(4) == 4, "");
+  static_assert(small_map.count(6) == 0, "");
+}
+
+TEST_CASE("frozen::unordered_map with dense keys", "[unordered_map]") {
+  enum class opcode : unsigned char { nop = 0x90, ret = 0xc3, call = 0xe8, jmp = 0xe9, hlt = 0xf4 };
+
+  SECTION("keys within the direct table") {
+    constexpr frozen::unordered_map<int, int, 8, frozen::elsa<int>, std::equal_to<int>,
+                                    frozen::dense_pmh<>>
+        squares = {{-3, 9}, {-2, 4}, {0, 0}, {1, 1}, {2, 4}, {4, 16}, {5, 25}, {7, 49}};
+    static_assert(squares.at(-2) == 4, "");
+    static_assert(squares.count(3) == 0, "");
+    for (int i = -16; i < 16; ++i) {
+      auto const where = squares.find(i);
+      if (i >= -3 && i <= 7 && i != -1 && i != 3 && i != 6)
+        REQUIRE(where->second == i * i);
+      else
+        REQUIRE(where == squares.end());
+    }
+
+    std::vector<int> queries{7, 6, -3, 100, -100};
+    std::vector<std::size_t> counts(queries.size());
+    squares.count_many(queries.begin(), queries.end(), counts.begin());
+    REQUIRE((counts == std::vector<std::size_t>{1, 0, 1, 0, 0}));
+  }
+
+  SECTION("keys beyond the direct table") {
+    constexpr frozen::unordered_map<opcode, int, 5, frozen::elsa<opcode>, std::equal_to<opcode>,
+                                    frozen::dense_pmh<frozen::slot_ordered_pmh>>
+        lengths = {{opcode::nop, 1}, {opcode::ret, 1}, {opcode::call, 5}, {opcode::jmp, 5}, {opcode::hlt, 1}};
+    static_assert(lengths.at(opcode::call) == 5, "");
+    static_assert(lengths.count(static_cast<opcode>(0x91)) == 0, "");
+    for (int i = 0; i < 256; ++i)
+      REQUIRE(lengths.count(static_cast<opcode>(i)) == (i == 0x90 || i == 0xc3 || i == 0xe8 || i == 0xe9 || i == 0xf4));
+  }
+}
+
+TEST_CASE("frozen::unordered_map with composite keys", "[unordered_map]") {
+  using point = std::pair<int, int>;
+  constexpr frozen::unordered_map<point, int, 6> grid = {
+      {{0, 0}, 0}, {{0, 1}, 1}, {{1, 0}, 2}, {{1, 1}, 3}, {{-1, 0}, 4}, {{0, -1}, 5}};
+  static_assert(grid.at({1, 0}) == 2, "pair keys");
+  static_assert(!grid.count({2, 0}), "pair keys");
+  REQUIRE(grid.at({0, -1}) == 5);
+  REQUIRE(!grid.count({-1, -1}));
+  REQUIRE(frozen::elsa<point>{}({0, 1}, 0) != frozen::elsa<point>{}({1, 0}, 0));
+
+  using route = std::tuple<frozen::string, unsigned, char>;
+  constexpr frozen::unordered_map<route, int, 3> routes = {
+      {route{"GET", 1, 'a'}, 1}, {route{"GET", 2, 'a'}, 2}, {route{"PUT", 1, 'a'}, 3}};
+  static_assert(routes.at(route{"PUT", 1, 'a'}) == 3, "tuple keys");
+  static_assert(!routes.count(route{"PUT", 2, 'a'}), "tuple keys");
+
+  // UUID-like keys, hashed as two words
+  using uuid = std::array<std::uint8_t, 16>;
+  constexpr uuid a{{0x12, 0x3e, 0x45, 0x67, 0xe8, 0x9b, 0x12, 0xd3, 0xa4, 0x56, 0x42, 0x66, 0x14, 0x17, 0x40, 0x00}};
+  constexpr uuid b{{0x12, 0x3e, 0x45, 0x67, 0xe8, 0x9b, 0x12, 0xd3, 0xa4, 0x56, 0x42, 0x66, 0x14, 0x17, 0x40, 0x01}};
+  constexpr uuid c{{0x92, 0x3e, 0x45, 0x67, 0xe8, 0x9b, 0x12, 0xd3, 0xa4, 0x56, 0x42, 0x66, 0x14, 0x17, 0x40, 0x00}};
+  constexpr frozen::unordered_map<uuid, int, 2> uuids = {{a, 1}, {b, 2}};
+  REQUIRE(uuids.at(a) == 1);
+  REQUIRE(uuids.at(b) == 2);
+  REQUIRE(!uuids.count(c));
+
+  constexpr frozen::unordered_map<std::array<point, 2>, int, 2> segments = {
+      {{{{0, 0}, {1, 1}}}, 1}, {{{{1, 1}, {0, 0}}}, 2}};
+  REQUIRE(segments.at({{{1, 1}, {0, 0}}}) == 2);
+
+  // a second word that cancels the constant it is mixed with
+  using words = std::pair<std::uint64_t, std::uint64_t>;
+  constexpr std::uint64_t cancel = 0xe7037ed1a0b428dbULL;
+  static_assert(frozen::elsa<words>{}({1, cancel}, 0) != frozen::elsa<words>{}({2, cancel}, 0), "pair keys");
+  constexpr frozen::unordered_set<words, 2> cancelling = {{1, cancel}, {2, cancel}};
+  REQUIRE(cancelling.count({1, cancel}));
+  REQUIRE(cancelling.count({2, cancel}));
+  REQUIRE(!cancelling.count({3, cancel}));
+}
+
 TEST_CASE("frozen::unordered_map <> frozen::make_unordered_map", "[unordered_map]") {
   constexpr frozen::unordered_map<int, int, 128> frozen_map = { INIT_SEQ };
   constexpr auto frozen_map2 = frozen::make_unordered_map<int, int>({INIT_SEQ});
@@ -161,3 +287,55 @@ TEST_CASE("access", "[unordered_map]") {
   REQUIRE(4 == ce.at(3));
   REQUIRE_THROWS(ce.at(33));
 }
+
+TEST_CASE("frozen::unordered_map batched lookups", "[unordered_map]") {
+  constexpr frozen::unordered_map<int, int, 128> frozen_map = {INIT_SEQ};
+  std::vector<int> queries;
+  for (auto const &kv : frozen_map)
+    queries.push_back(kv.first);
+  for (int v = -40; v < 4; ++v)
+    queries.push_back(v);
+
+  std::vector<decltype(frozen_map)::const_iterator> found(queries.size());
+  std::vector<std::size_t> counts(queries.size());
+  REQUIRE(frozen_map.find_many(queries.begin(), queries.end(), found.begin()) == found.end());
+  REQUIRE(frozen_map.count_many(queries.begin(), queries.end(), counts.begin()) == counts.end());
+  for (std::size_t i = 0; i < queries.size(); ++i) {
+    REQUIRE(found[i] == frozen_map.find(queries[i]));
+    REQUIRE(counts[i] == frozen_map.count(queries[i]));
+  }
+}
+
+TEST_CASE("frozen::unordered_map with soa layout", "[unordered_map]") {
+  using record = std::array<char, 100>;
+  frozen::bits::carray<std::pair<int, record>, 64> items;
+  for (int i = 0; i < 64; ++i) {
+    items[i].first = 5 * i - 100;
+    items[i].second.fill(char(i));
+  }
+  frozen::unordered_map<int, record, 64, frozen::elsa<int>, std::equal_to<int>, frozen::hanov_pmh,
+                        frozen::soa_layout> const records(items);
+
+  for (int i = 0; i < 64; ++i) {
+    REQUIRE(records.at(5 * i - 100)[99] == char(i));
+    REQUIRE(records.find(5 * i - 100)->second[0] == char(i));
+    REQUIRE(!records.count(5 * i - 99));
+  }
+  std::size_t visited = 0;
+  for (auto const &item : records)
+    visited += records.at(item.first)[0] == item.second[0];
+  REQUIRE(visited == 64);
+
+  std::vector<int> queries = {-100, -99, 215};
+  std::vector<decltype(records)::const_iterator> found(queries.size());
+  records.find_many(queries.begin(), queries.end(), found.begin());
+  REQUIRE(found[0]->first == -100);
+  REQUIRE(found[1] == records.end());
+  REQUIRE(found[2]->second[1] == char(63));
+
+  constexpr frozen::unordered_map<int, char, 3, frozen::elsa<int>, std::equal_to<int>, frozen::hanov_pmh,
+                                  frozen::soa_layout>
+      letters = {{1, 'a'}, {2, 'b'}, {3, 'c'}};
+  static_assert(letters.at(2) == 'b', "");
+  static_assert(!letters.count(4), "");
+}
@@ -1,3 +1,4 @@
+#include <cstddef>
 #include <frozen/string.h>
 #include <frozen/unordered_map.h>
 #include <iostream>
@@ -68,6 +69,33 @@ TEST_CASE("frozen::unordered_map<str, int> <> std::unordered_map",
       REQUIRE(std_map.count(v.first));
   }
 
+  SECTION("checking compact pmh policy") {
+    constexpr frozen::unordered_map<frozen::string, int, 128, frozen::elsa<frozen::string>,
+                                    std::equal_to<frozen::string>, frozen::pthash_pmh>
+        compact_map = {INIT_SEQ};
+    REQUIRE(compact_map.size() == std_map.size());
+    for (auto v : std_map)
+      REQUIRE(compact_map.at(v.first) == v.second);
+    for (auto v : compact_map)
+      REQUIRE(std_map.at(v.first) == v.second);
+    REQUIRE(compact_map.count("0") == 0);
+    REQUIRE(compact_map.find("1977 ") == compact_map.end());
+  }
+
+  SECTION("checking cache line block policy") {
+    constexpr frozen::unordered_map<frozen::string, int, 128, frozen::elsa<frozen::string>,
+                                    std::equal_to<frozen::string>, frozen::block_pmh>
+        block_map = {INIT_SEQ};
+    static_assert(alignof(decltype(block_map)) <= alignof(std::max_align_t), "");
+    REQUIRE(block_map.size() == std_map.size());
+    for (auto v : std_map)
+      REQUIRE(block_map.at(v.first) == v.second);
+    for (auto v : block_map)
+      REQUIRE(std_map.at(v.first) == v.second);
+    REQUIRE(block_map.count("0") == 0);
+    REQUIRE(block_map.find("1977 ") == block_map.end());
+    REQUIRE_THROWS_AS(block_map.at("1977 "), std::out_of_range const &);
+  }
 }
 
 TEST_CASE("various frozen::unordered_map config", "[unordered_map]") {
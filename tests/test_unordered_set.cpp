@@ -1,7 +1,10 @@
+#include <algorithm>
+#include <cstdint>
 #include <frozen/string.h>
 #include <frozen/unordered_set.h>
 #include <iostream>
 #include <unordered_set>
+#include <vector>
 
 #include "bench.hpp"
 #include "catch.hpp"
@@ -125,6 +128,52 @@ TEST_CASE("frozen::unordered_set<int> <> std::unordered_set",
 
 }
 
+TEST_CASE("frozen::unordered_set with compact pmh policy", "[unordered_set]") {
+  const std::unordered_set<int> std_set = {INIT_SEQ};
+  constexpr frozen::unordered_set<int, 129, frozen::elsa<int>, std::equal_to<int>,
+                                  frozen::pthash_pmh> frozen_set = {INIT_SEQ};
+  REQUIRE(std_set.size() == frozen_set.size());
+  for (auto v : std_set)
+    REQUIRE(frozen_set.count(v));
+  for (auto v : frozen_set)
+    REQUIRE(std_set.count(v));
+  for (int v = -64; v < 0; ++v)
+    REQUIRE(frozen_set.find(v) == frozen_set.end());
+
+  // one pilot byte per bucket of three keys and a few remapped positions
+  using tables_type = frozen::bits::pthash_tables<129, frozen::elsa<int>>;
+  REQUIRE(sizeof(tables_type) * 8 / 129 < 8);
+
+  constexpr frozen::unordered_set<unsigned, 1, frozen::elsa<unsigned>, std::equal_to<unsigned>,
+                                  frozen::pthash_pmh> singleton = {3};
+  static_assert(singleton.count(3), "");
+  static_assert(!singleton.count(4), "");
+}
+
+TEST_CASE("frozen::unordered_set with integer mixers", "[unordered_set]") {
+  static_assert(frozen::bits::multiply_fold(uint64_t(1) << 63, 4) == 2, "high half");
+  static_assert(frozen::bits::multiply_fold(~uint64_t(0), ~uint64_t(0)) == ~uint64_t(0), "both halves");
+
+  const std::unordered_set<int> std_set = {INIT_SEQ};
+  constexpr frozen::unordered_set<int, 129, frozen::elsa<int, frozen::fmix_mixer>> fmix_set = {INIT_SEQ};
+  constexpr frozen::unordered_set<int, 129, frozen::elsa<int, frozen::wang_mixer>> wang_set = {INIT_SEQ};
+  for (auto v : std_set) {
+    REQUIRE(fmix_set.count(v));
+    REQUIRE(wang_set.count(v));
+  }
+  for (int v = -64; v < 0; ++v) {
+    REQUIRE(!fmix_set.count(v));
+    REQUIRE(!wang_set.count(v));
+  }
+
+  // sequential and strided keys
+  constexpr frozen::unordered_set<unsigned, 8> sequential = {0, 1, 2, 3, 4, 5, 6, 7};
+  constexpr frozen::unordered_set<unsigned, 8> strided = {0, 1 << 12, 2 << 12, 3 << 12,
+                                                          4 << 12, 5 << 12, 6 << 12, 7 << 12};
+  static_assert(sequential.count(7) && !sequential.count(8), "");
+  static_assert(strided.count(7 << 12) && !strided.count(8 << 12), "");
+}
+
 TEST_CASE("frozen::unordered_set with enum keys", "[unordered_set]") {
   enum class some_enum {
     A,B,C
@@ -154,3 +203,143 @@ TEST_CASE("frozen::unordered_set constexpr", "[unordered_set]") {
   static_assert(!ce.count(0), "");
   static_assert(ce.find(0) == ce.end(), "");
 }
+
+TEST_CASE("frozen::unordered_set table footprint", "[unordered_set]") {
+  // 129 keys are addressed with 8 bit indices and 16 bit seeds
+  using tables_type = frozen::bits::pmh_tables<256, 129, frozen::elsa<int>>;
+  static_assert(sizeof(tables_type::index_type) == 1, "");
+  static_assert(sizeof(tables_type::seed_or_index_type) == 2, "");
+  REQUIRE(sizeof(frozen::unordered_set<int, 129>) <= 129 * sizeof(int) + 256 * 3 + 32);
+
+  // while larger sets need wider ones
+  using large_tables_type = frozen::bits::pmh_tables<1024, 1000, frozen::elsa<int>>;
+  static_assert(sizeof(large_tables_type::index_type) == 2, "");
+  static_assert(sizeof(large_tables_type::seed_or_index_type) == 2, "");
+
+  // blocks of the cache line layout fill a cache line
+  static_assert(sizeof(frozen::bits::pmh_block<std::uint8_t>) == 64, "");
+  static_assert(sizeof(frozen::bits::pmh_block<std::uint16_t>) == 64, "");
+  static_assert(sizeof(frozen::bits::pmh_block<std::uint32_t>) == 64, "");
+  static_assert(frozen::bits::pmh_block<std::uint8_t>::capacity == 30, "");
+}
+
+TEST_CASE("frozen::unordered_set construction budget", "[unordered_set]") {
+  using small_budget = frozen::pmh_budget<2, 8>;
+  using hanov_set = frozen::unordered_set<int, 2, frozen::elsa<int>, std::equal_to<int>,
+                                          frozen::basic_hanov_pmh<frozen::pmh_default_storage, small_budget>>;
+  using pthash_set = frozen::unordered_set<int, 2, frozen::elsa<int>, std::equal_to<int>,
+                                           frozen::basic_pthash_pmh<small_budget>>;
+  using crowded_set = frozen::unordered_set<int, 9, frozen::elsa<int>, std::equal_to<int>,
+                                            frozen::basic_hanov_pmh<frozen::pmh_default_storage, small_budget>>;
+
+  // distinct keys fit in the budget
+  hanov_set const ok = {1, 2};
+  REQUIRE(ok.count(1));
+  REQUIRE(ok.count(2));
+
+  // equal keys never get a slot, nor a pilot, of their own
+  REQUIRE_THROWS_AS(hanov_set({1, 1}), std::runtime_error const &);
+  REQUIRE_THROWS_AS(pthash_set({1, 1}), std::runtime_error const &);
+
+  // and too many of them overflow their bucket
+  REQUIRE_THROWS_AS(crowded_set({1, 1, 1, 1, 1, 1, 1, 1, 1}), std::runtime_error const &);
+}
+
+namespace {
+struct counting_hash {
+  std::size_t *calls;
+  std::size_t operator()(int value, std::size_t seed) const {
+    ++*calls;
+    return frozen::elsa<int>{}(value, seed);
+  }
+};
+
+struct counting_equal {
+  std::size_t *calls;
+  bool operator()(int lhs, int rhs) const {
+    ++*calls;
+    return lhs == rhs;
+  }
+};
+}
+
+TEST_CASE("frozen::unordered_set hashes each key once", "[unordered_set]") {
+  std::size_t calls = 0;
+  frozen::unordered_set<int, 16, counting_hash> const set{
+      {0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15}, counting_hash{&calls}, std::equal_to<int>{}};
+
+  calls = 0;
+  for (int v = -16; v < 32; ++v)
+    REQUIRE(set.count(v) == (v >= 0 && v < 16));
+  REQUIRE(calls == 48);
+}
+
+TEST_CASE("frozen::unordered_set with fingerprints", "[unordered_set]") {
+  std::size_t calls = 0;
+  frozen::unordered_set<int, 16, frozen::elsa<int>, counting_equal,
+                        frozen::fingerprint_pmh<frozen::hanov_pmh>> const set{
+      {0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15}, frozen::elsa<int>{}, counting_equal{&calls}};
+
+  for (int v = 0; v < 16; ++v)
+    REQUIRE(set.count(v));
+  REQUIRE(calls == 16);
+
+  // about one miss in 256 reaches KeyEqual
+  calls = 0;
+  for (int v = 16; v < 4096; ++v)
+    REQUIRE(!set.count(v));
+  REQUIRE(calls < 64);
+
+  constexpr frozen::unordered_set<int, 4, frozen::elsa<int>, std::equal_to<int>,
+                                  frozen::fingerprint_pmh<frozen::pthash_pmh, std::uint16_t>>
+      wide = {1, 2, 3, 4};
+  static_assert(wide.count(3), "");
+  static_assert(!wide.count(5), "");
+}
+
+TEST_CASE("frozen::unordered_set batched lookups", "[unordered_set]") {
+  constexpr frozen::unordered_set<int, 129> frozen_set = {INIT_SEQ};
+  std::vector<int> queries = {INIT_SEQ};
+  for (int v = -40; v < 4; ++v)
+    queries.push_back(v);
+
+  std::vector<decltype(frozen_set)::const_iterator> found(queries.size());
+  std::vector<std::size_t> counts(queries.size());
+  REQUIRE(frozen_set.find_many(queries.begin(), queries.end(), found.begin()) == found.end());
+  REQUIRE(frozen_set.count_many(queries.begin(), queries.end(), counts.begin()) == counts.end());
+  for (std::size_t i = 0; i < queries.size(); ++i) {
+    REQUIRE(found[i] == frozen_set.find(queries[i]));
+    REQUIRE(counts[i] == frozen_set.count(queries[i]));
+  }
+
+  constexpr frozen::unordered_set<int, 129, frozen::elsa<int>, std::equal_to<int>,
+                                  frozen::fingerprint_pmh<frozen::block_pmh>> block_set = {INIT_SEQ};
+  std::vector<std::size_t> block_counts(queries.size());
+  block_set.count_many(queries.begin(), queries.end(), block_counts.begin());
+  REQUIRE(block_counts == counts);
+}
+
+TEST_CASE("frozen::unordered_set of few keys", "[unordered_set]") {
+  frozen::bits::carray<int64_t, 11> keys;
+  for (int64_t i = 0; i < 11; ++i)
+    keys[i] = (i - 5) * (int64_t(1) << 40) + i;
+  frozen::unordered_set<int64_t, 11> const frozen_set(keys);
+  for (auto key : keys) {
+    REQUIRE(*frozen_set.find(key) == key);
+    REQUIRE(!frozen_set.count(key + 1));
+    REQUIRE(!frozen_set.count(key ^ (int64_t(1) << 40)));
+  }
+
+  constexpr frozen::unordered_set<int, 12> small = {-1, 0, 3, 4, 5, 6, 7, 100, 8, 9, 10, 11};
+  static_assert(small.count(100) && small.count(-1) && !small.count(2), "");
+  static_assert(small.find(100) == small.begin() + 7, "");
+  for (int v = -5; v < 120; ++v)
+    REQUIRE(small.count(v) == std::size_t(std::count(small.begin(), small.end(), v)));
+
+  // only the keys are stored, and batched lookups scan them too
+  static_assert(sizeof(small) <= sizeof(frozen::bits::carray<int, 12>) + 2 * sizeof(int), "");
+  std::vector<int> queries = {-1, 2, 100, 11, 12};
+  std::vector<std::size_t> counts(queries.size());
+  small.count_many(queries.begin(), queries.end(), counts.begin());
+  REQUIRE((counts == std::vector<std::size_t>{1, 0, 1, 1, 0}));
+}
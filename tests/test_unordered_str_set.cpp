@@ -1,3 +1,4 @@
+#include <frozen/crc_hash.h>
 #include <frozen/string.h>
 #include <frozen/unordered_set.h>
 #include <iostream>
@@ -87,4 +88,56 @@ TEST_CASE("frozen::unordered_set<str> <> std::unordered_set",
       REQUIRE(std_set.count(v));
   }
 
+  SECTION("crc hash") {
+    constexpr frozen::unordered_set<frozen::string, 128, frozen::crc_hash<frozen::string>>
+        crc_set = {INIT_SEQ};
+    static_assert(crc_set.count("1110779988"), "built with the table based CRC");
+    static_assert(!crc_set.count("1110779989"), "built with the table based CRC");
+    // looked up with the crc32 instruction when available
+    for (auto v : std_set)
+      REQUIRE(crc_set.count(v));
+    REQUIRE(!crc_set.count("1110779989"));
+    REQUIRE(!crc_set.count("a string that is longer than any key"));
+  }
+
+  SECTION("key positions") {
+    constexpr frozen::unordered_set<frozen::string, 128, frozen::elsa<frozen::string>,
+                                    std::equal_to<frozen::string>, frozen::key_position_pmh<>>
+        positions_set = {INIT_SEQ};
+    for (auto v : std_set)
+      REQUIRE(positions_set.count(v));
+    REQUIRE(!positions_set.count("1110779989"));
+    REQUIRE(!positions_set.count("a string that is longer than any key"));
+    REQUIRE(positions_set.hash_function()("19", 0) == frozen::elsa<frozen::string>{}("19", 0));
+  }
+}
+
+TEST_CASE("key positions", "[unordered_set]") {
+  using frozen::string;
+  using frozen::bits::Get;
+  using hash_type = frozen::bits::key_position_hash<frozen::elsa<string>>;
+
+  // the length and one byte tell these apart
+  constexpr frozen::bits::carray<string, 6> entities{"amp", "lt", "gt", "quot", "nbsp", "apos"};
+  constexpr hash_type hash = frozen::bits::make_key_position_hash(entities, frozen::elsa<string>{}, Get{});
+  static_assert(!hash.whole_key && hash.count == 1, "one position");
+
+  constexpr frozen::bits::carray<string, 4> urls{
+      "https://example.com/index.html", "https://example.com/about.html",
+      "https://example.com/index.htm", "https://example.com/about.htm"};
+  constexpr hash_type url_hash = frozen::bits::make_key_position_hash(urls, frozen::elsa<string>{}, Get{});
+  static_assert(!url_hash.whole_key && url_hash.count == 1, "one position");
+
+  // every position only tells one key from the others
+  constexpr frozen::bits::carray<string, 9> ones{
+      "00000000", "10000000", "01000000", "00100000", "00010000",
+      "00001000", "00000100", "00000010", "00000001"};
+  constexpr frozen::unordered_set<string, 9, frozen::elsa<string>, std::equal_to<string>,
+                                  frozen::key_position_pmh<frozen::block_pmh>>
+      ones_set{ones};
+  static_assert(frozen::bits::make_key_position_hash(ones, frozen::elsa<string>{}, Get{}).whole_key,
+                "whole keys");
+  for (auto v : ones)
+    REQUIRE(ones_set.count(v));
+  REQUIRE(!ones_set.count("00000011"));
 }